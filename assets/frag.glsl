@@ -17,21 +17,33 @@
 #version 120
 #define AMBIENT_OCCLUSION_COLOR_DELTA vec3(0.7)
 #define AMBIENT_OCCLUSION_STRENGTH 0.008
+#define AA_DEPTH_WEIGHT 0.25
+#define AA_EXTRA_SAMPLES 3.0
 #define ANTIALIASING_SAMPLES 1
 #define BACKGROUND_COLOR vec3(0.6,0.8,1.0)
-#define COL col_scene
-#define DE de_scene
+#define COL col_fractal
+#define DE de_fractal
+#define DEEP_ITERS 32
 #define DIFFUSE_ENABLED 0
 #define DIFFUSE_ENHANCED_ENABLED 1
+#define EXIT_BOUND 2.0
+#define EXIT_CLIPPED 3.0
+#define EXIT_MARCHES 4.0
+#define EXIT_OBJECT 1.0
+#define EXIT_SURFACE 0.0
 #define FOCAL_DIST 1.73205080757
 #define FOG_ENABLED 0
+#define FRACTAL_ITERS 16
 #define LIGHT_COLOR vec3(1.0,0.95,0.8)
 #define LIGHT_DIRECTION vec3(-0.36, 0.8, 0.48)
 #define MAX_DIST 30.0
 #define MAX_MARCHES 1000
 #define MIN_DIST 1e-5
+#define MIN_ITERS 4
 #define PI 3.14159265358979
+#define PROBE_RANGE 2.0
 #define SHADOWS_ENABLED 1
+#define SHADOW_CUTOFF 0.02
 #define SHADOW_DARKNESS 0.7
 #define SHADOW_SHARPNESS 10.0
 #define SPECULAR_HIGHLIGHT 40
@@ -40,21 +52,62 @@
 #define SUN_SHARPNESS 2.0
 #define SUN_SIZE 0.004
 #define VIGNETTE_STRENGTH 0.5
+#define VOLUME_BAND 2.0
+#define VOLUME_MAX_TEXEL 1.0
 
 uniform mat4 iMat;
 uniform vec2 iResolution;
+uniform vec2 iJitter;
+uniform vec4 iTile; //Offset of this tile and size of the whole frame
 uniform vec3 iDebug;
 
 uniform float iFracScale;
 uniform float iFracAng1;
 uniform float iFracAng2;
+uniform vec4 iFracRot; //Cosine and sine of both angles, for the double-float folds
 uniform vec3 iFracShift;
 uniform vec3 iFracCol;
+uniform float iFracBound;
+uniform float iMarchOmega;
+uniform float iLODBias;
+uniform float iMaxMarches; //March detail from the quality governor, never finer than the defines
+uniform float iMinDist;
+uniform float iShadowSharpness;
 uniform vec3 iMarblePos;
 uniform float iMarbleRad;
 uniform float iFlagScale;
 uniform vec3 iFlagPos;
 uniform float iExposure;
+uniform vec3 iOrigin; //Position everything is relative to, plus iOriginLow as a double-float
+uniform vec3 iOriginLow;
+uniform float iDeepZoom; //Halvings of the surface distance while exploring
+uniform float iDeepIters; //Folds that run in double-float
+uniform vec4 iVolume; //Resolution, half size and atlas columns and rows of the baked level volume, 0 to march
+uniform sampler2D iVolumeTex; //Light visibility in red, distance bound in green
+uniform float iProbeSize; //Face size of the marble probe in pixels, 0 to trace the marble's rays
+uniform sampler2D iProbeTex; //Faces +x -x +y on the bottom row, -y +z -z above
+
+uniform float iAAPass;
+uniform float iAAThreshold;
+uniform float iAABudget;
+uniform sampler2D iAAColor;
+uniform sampler2D iAAEdges;
+
+//March detail for this frame, see main
+float max_marches = float(MAX_MARCHES);
+float min_dist = MIN_DIST;
+float shadow_sharpness = SHADOW_SHARPNESS;
+
+//Debug counters for this pixel, selected by iDebug.x
+float march_count = 0.0;
+float de_calls = 0.0;
+float view_steps = 0.0;
+float shadow_steps = 0.0;
+float march_exit = EXIT_SURFACE;
+float pixel_exit = EXIT_SURFACE;
+
+//Travelled distance of the last scene() ray, MAX_DIST if it missed
+float scene_td = MAX_DIST;
 
 vec3 refraction(vec3 rd, vec3 n, float p) {
   float dot_nd = dot(rd, n);
@@ -105,6 +158,42 @@ void rotZ(inout vec4 z, float a) {
 	rotZ(z, sin(a), cos(a));
 }
 
+//##########################################
+//   Double-float arithmetic
+//##########################################
+//Each value is the unevaluated sum of two floats, about twice the precision.
+//The error terms only survive if the compiler keeps the operation order.
+struct df3 {
+	vec3 hi;
+	vec3 lo;
+};
+df3 df_add(df3 a, df3 b) {
+	vec3 s = a.hi + b.hi;
+	vec3 v = s - a.hi;
+	vec3 e = (a.hi - (s - v)) + (b.hi - v) + a.lo + b.lo;
+	vec3 hi = s + e;
+	return df3(hi, e - (hi - s));
+}
+df3 df_mul(df3 a, vec3 b) {
+	//Dekker's split, there is no fma before GLSL 4
+	vec3 p = a.hi * b;
+	vec3 t = a.hi * 4097.0;
+	vec3 ah = t - (t - a.hi);
+	vec3 al = a.hi - ah;
+	t = b * 4097.0;
+	vec3 bh = t - (t - b);
+	vec3 bl = b - bh;
+	vec3 e = ((ah*bh - p) + ah*bl + al*bh) + al*bl + a.lo*b;
+	vec3 hi = p + e;
+	return df3(hi, e - (hi - p));
+}
+void df_menger_fold(inout df3 z) {
+	//Same as mengerFold, which only ever swaps coordinates
+	if ((z.hi.x - z.hi.y) + (z.lo.x - z.lo.y) < 0.0) { z.hi.xy = z.hi.yx; z.lo.xy = z.lo.yx; }
+	if ((z.hi.x - z.hi.z) + (z.lo.x - z.lo.z) < 0.0) { z.hi.xz = z.hi.zx; z.lo.xz = z.lo.zx; }
+	if ((z.hi.y - z.hi.z) + (z.lo.y - z.lo.z) < 0.0) { z.hi.yz = z.hi.zy; z.lo.yz = z.lo.zy; }
+}
+
 //##########################################
 //   Primitive DEs
 //##########################################
@@ -128,8 +217,46 @@ float de_capsule(vec4 p, float h, float r) {
 //##########################################
 //   Main DEs
 //##########################################
+float pixel_footprint(vec3 p) {
+  //Width of one pixel at this point's distance from the camera
+  return length(p - iMat[3].xyz) * 2.0 / (iTile.w * FOCAL_DIST);
+}
+int frac_iters(vec3 p) {
+  //Skip the folds whose details are smaller than this point's pixel footprint
+  if (iLODBias <= 0.0 || iFracScale <= 1.0) { return FRACTAL_ITERS + int(iDeepIters); }
+  float iters = log(6.0 / (pixel_footprint(p) * iLODBias)) / log(iFracScale);
+  return int(clamp(ceil(iters), float(MIN_ITERS), float(FRACTAL_ITERS) + iDeepIters));
+}
+int deep_folds(inout vec4 p, int iters, inout vec3 orbit) {
+  //Float positions lose the detail of a deep zoom, and the first folds magnify
+  //that error the most, so those run in double-float from the absolute position
+  int deep_iters = int(min(float(iters), iDeepIters));
+  if (deep_iters == 0) {
+    p.xyz += iOrigin;
+    return 0;
+  }
+  df3 z = df_add(df3(iOrigin, iOriginLow), df3(p.xyz, vec3(0.0)));
+  for (int i = 0; i < DEEP_ITERS; ++i) {
+    if (i >= deep_iters) { break; }
+    vec3 s = sign(z.hi);
+    z = df3(z.hi * s, z.lo * s);
+    z = df_add(df_mul(z, vec3(iFracRot.x, iFracRot.x, 1.0)), df_mul(df3(z.hi.yxz, z.lo.yxz), vec3(iFracRot.y, -iFracRot.y, 0.0)));
+    df_menger_fold(z);
+    z = df_add(df_mul(z, vec3(1.0, iFracRot.z, iFracRot.z)), df_mul(df3(z.hi.xzy, z.lo.xzy), vec3(0.0, iFracRot.w, -iFracRot.w)));
+    z = df_add(df_mul(z, vec3(iFracScale)), df3(iFracShift, vec3(0.0)));
+    p.w *= iFracScale;
+    orbit = max(orbit, z.hi*iFracCol);
+  }
+  p.xyz = z.hi + z.lo;
+  return deep_iters;
+}
 float de_fractal(vec4 p) {
-  for (int i = 0; i < 16; ++i) {
+  de_calls += 1.0;
+  int iters = frac_iters(p.xyz);
+  vec3 orbit = vec3(0.0);
+  iters -= deep_folds(p, iters, orbit);
+  for (int i = 0; i < FRACTAL_ITERS + DEEP_ITERS; ++i) {
+    if (i >= iters) { break; }
     p.xyz = abs(p.xyz);
     rotZ(p, iFracAng1);
     mengerFold(p);
@@ -140,8 +267,12 @@ float de_fractal(vec4 p) {
   return de_box(p, vec3(6.0));
 }
 vec4 col_fractal(vec4 p) {
+  de_calls += 1.0;
   vec3 orbit = vec3(0.0);
-  for (int i = 0; i < 16; ++i) {
+  int iters = frac_iters(p.xyz);
+  iters -= deep_folds(p, iters, orbit);
+  for (int i = 0; i < FRACTAL_ITERS + DEEP_ITERS; ++i) {
+    if (i >= iters) { break; }
     p.xyz = abs(p.xyz);
     rotZ(p, iFracAng1);
     mengerFold(p);
@@ -152,103 +283,271 @@ vec4 col_fractal(vec4 p) {
   }
   return vec4(orbit, de_box(p, vec3(6.0)));
 }
-float de_marble(vec4 p) {
-	return de_sphere(p - vec4(iMarblePos, 0), iMarbleRad);
+
+//##########################################
+//   Analytic intersections
+//##########################################
+float hit_sphere(vec3 ro, vec3 rd, vec3 c, float r) {
+  vec3 oc = ro - c;
+  float b = dot(oc, rd);
+  float h = b*b - dot(oc, oc) + r*r;
+  if (h < 0.0) { return -1.0; }
+  return -b - sqrt(h);
 }
-vec4 col_marble(vec4 p) {
-	return vec4(0, 0, 0, de_sphere(p - vec4(iMarblePos, 0), iMarbleRad));
+float hit_box(vec3 ro, vec3 rd, vec3 c, vec3 s, out vec3 n) {
+  vec3 m = 1.0 / mix(rd, vec3(1e-10), vec3(equal(rd, vec3(0.0))));
+  vec3 o = (ro - c) * m;
+  vec3 k = abs(m) * s;
+  vec3 t1 = -o - k;
+  vec3 t2 = -o + k;
+  float tn = max(max(t1.x, t1.y), t1.z);
+  float tf = min(min(t2.x, t2.y), t2.z);
+  if (tn > tf || tn < 0.0) { return -1.0; }
+  n = -sign(rd) * step(t1.yzx, t1.xyz) * step(t1.zxy, t1.xyz);
+  return tn;
 }
-float de_flag(vec4 p) {
-  vec3 f_pos = iFlagPos + vec3(1.5, 4, 0)*iFlagScale;
-  float d = de_box(p - vec4(f_pos, 0), vec3(1.5, 0.8, 0.08)*iMarbleRad);
-  d = min(d, de_capsule(p - vec4(iFlagPos + vec3(0, iFlagScale*2.4, 0), 0), iMarbleRad*2.4, iMarbleRad*0.18));
-  return d;
+float hit_capsule(vec3 ro, vec3 rd, vec3 c, float h, float r) {
+  //Vertical capsule, same shape as de_capsule
+  vec3 pa = c - vec3(0.0, h, 0.0);
+  vec3 oa = ro - pa;
+  float baba = 4.0*h*h;
+  float bard = 2.0*h*rd.y;
+  float baoa = 2.0*h*oa.y;
+  float qa = baba - bard*bard;
+  float qb = baba*dot(rd, oa) - baoa*bard;
+  float qc = baba*dot(oa, oa) - baoa*baoa - r*r*baba;
+  float qh = qb*qb - qa*qc;
+  if (qh < 0.0) { return -1.0; }
+  float t = (-qb - sqrt(qh)) / qa;
+  float y = baoa + t*bard;
+  if (y > 0.0 && y < baba) { return t; }
+  //Hit one of the end caps instead
+  return hit_sphere(ro, rd, (y <= 0.0 ? pa : c + vec3(0.0, h, 0.0)), r);
 }
-vec4 col_flag(vec4 p) {
+
+//##########################################
+//   Marble and flag
+//##########################################
+float hit_objects(vec3 ro, vec3 rd, out vec4 col, out vec3 n) {
+  float t = MAX_DIST * 2.0;
+  col = vec4(0.0);
+  n = vec3(0.0, 1.0, 0.0);
+
+  //Glass marble, marked with w=1
+  float t_m = hit_sphere(ro, rd, iMarblePos, iMarbleRad);
+  if (t_m > 0.0 && t_m < t) {
+    t = t_m;
+    col = vec4(0.0, 0.0, 0.0, 1.0);
+    n = normalize(ro + rd*t - iMarblePos);
+  }
+
+  //Flag
   vec3 f_pos = iFlagPos + vec3(1.5, 4, 0)*iFlagScale;
-  float d1 = de_box(p - vec4(f_pos, 0), vec3(1.5, 0.8, 0.08)*iMarbleRad);
-  float d2 = de_capsule(p - vec4(iFlagPos + vec3(0, iFlagScale*2.4, 0), 0), iMarbleRad*2.4, iMarbleRad*0.18);
-  if (d1 < d2) {
-    return vec4(1.0, 0.2, 0.1, d1);
-  } else {
-    return vec4(0.9, 0.9, 0.1, d2);
+  vec3 n_box;
+  float t_b = hit_box(ro, rd, f_pos, vec3(1.5, 0.8, 0.08)*iMarbleRad, n_box);
+  if (t_b > 0.0 && t_b < t) {
+    t = t_b;
+    col = vec4(1.0, 0.2, 0.1, 0.0);
+    n = n_box;
+  }
+
+  //Flag pole
+  vec3 c_pos = iFlagPos + vec3(0, iFlagScale*2.4, 0);
+  float t_c = hit_capsule(ro, rd, c_pos, iMarbleRad*2.4, iMarbleRad*0.18);
+  if (t_c > 0.0 && t_c < t) {
+    t = t_c;
+    col = vec4(0.9, 0.9, 0.1, 0.0);
+    vec3 q = ro + rd*t - c_pos;
+    q.y -= clamp(q.y, -iMarbleRad*2.4, iMarbleRad*2.4);
+    n = normalize(q);
   }
+  return t;
 }
-float de_scene(vec4 p) {
-  float d = de_fractal(p);
-  d = min(d, de_marble(p));
-  d = min(d, de_flag(p));
-  return d;
-}
-vec4 col_scene(vec4 p) {
-  vec4 col = col_fractal(p);
-  vec4 col_f = col_flag(p);
-  if (col_f.w < col.w) { col = col_f; }
-  vec4 col_m = col_marble(p);
-  if (col_m.w < col.w) {
-    return vec4(col_m.xyz, 1.0);
+float shadow_objects(vec3 ro, vec3 rd, float sharpness) {
+  //Flag casts a hard shadow
+  vec3 n_box;
+  vec3 f_pos = iFlagPos + vec3(1.5, 4, 0)*iFlagScale;
+  if (hit_box(ro, rd, f_pos, vec3(1.5, 0.8, 0.08)*iMarbleRad, n_box) > 0.0 ||
+      hit_capsule(ro, rd, iFlagPos + vec3(0, iFlagScale*2.4, 0), iMarbleRad*2.4, iMarbleRad*0.18) > 0.0) {
+    return 0.0;
   }
-  return vec4(col.xyz, 0.0);
+
+  //Marble penumbra from the closest approach of the ray
+  vec3 oc = iMarblePos - ro;
+  float t = dot(oc, rd);
+  if (t <= 0.0) { return 1.0; }
+  float d = length(oc - rd*t) - iMarbleRad;
+  return clamp(sharpness * d / t, 0.0, 1.0);
 }
 
 //##########################################
 //   Main code
 //##########################################
-vec4 ray_march(inout vec4 p, vec4 ray, float sharpness) {
-	//March the ray
-	float d = DE(p);
-	if (d < 0.0 && sharpness == 1.0) {
-		vec3 v = iMarblePos.xyz - iMat[3].xyz;
-		d = dot(v, v) / dot(v, ray.xyz) - iMarbleRad;
+vec3 fractal_normal(vec4 p, out vec3 col) {
+	//Tetrahedron of samples, one of them also picks up the orbit trap color
+	vec4 e = vec4(min_dist, -min_dist, 0.0, 0.0);
+	vec4 col_d = COL(p + e.xxxz);
+	col = col_d.xyz;
+	vec3 n = e.xyy * DE(p + e.xyyz) +
+			 e.yyx * DE(p + e.yyxz) +
+			 e.yxy * DE(p + e.yxyz) +
+			 e.xxx * col_d.w;
+	return n / length(n);
+}
+
+vec2 clip_bound(vec3 ro, vec3 rd) {
+	//Entry and exit distance of the fractal's bounding sphere
+	ro += iOrigin;
+	float b = dot(ro, rd);
+	float h = b*b - dot(ro, ro) + iFracBound*iFracBound;
+	if (h < 0.0) { return vec2(MAX_DIST, -1.0); }
+	h = sqrt(h);
+	return vec2(max(-b - h, 0.0), -b + h);
+}
+
+bool in_volume(vec3 p) {
+	return iVolume.x > 0.0 && all(lessThan(abs(p + iOrigin), vec3(iVolume.y)));
+}
+vec4 sample_volume(vec3 p) {
+	//Each slice is a tile of the atlas, so only the depth is blended by hand
+	float res = iVolume.x;
+	vec3 t = clamp(((p + iOrigin) / iVolume.y * 0.5 + 0.5) * res - 0.5, 0.0, res - 1.0);
+	float z0 = floor(t.z);
+	float z1 = min(z0 + 1.0, res - 1.0);
+	vec2 atlas = iVolume.zw * res;
+	vec2 uv0 = (vec2(mod(z0, iVolume.z), floor(z0 / iVolume.z)) * res + t.xy + 0.5) / atlas;
+	vec2 uv1 = (vec2(mod(z1, iVolume.z), floor(z1 / iVolume.z)) * res + t.xy + 0.5) / atlas;
+	return mix(texture2D(iVolumeTex, uv0), texture2D(iVolumeTex, uv1), t.z - z0);
+}
+float de_march(vec4 p) {
+	//Far from the surface the baked bound is a safe step and much cheaper than the fractal
+	if (in_volume(p.xyz)) {
+		float far = max(sample_volume(p.xyz).g - 1.0 / 255.0, 0.0) * iVolume.y;
+		if (far > VOLUME_BAND * 2.0 * iVolume.y / iVolume.x) { return far; }
 	}
+	return DE(p);
+}
+
+vec4 ray_march(inout vec4 p, vec4 ray, float sharpness, float max_td) {
+	//Skip straight to the bounding sphere, or give up if it is missed
+	vec2 clip = clip_bound(p.xyz, ray.xyz);
+	if (clip.x > min(clip.y, max_td)) {
+		if (sharpness == 1.0) { march_exit = EXIT_CLIPPED; }
+		return vec4(MAX_DIST, 0.0, MAX_DIST, 1.0);
+	}
+	max_td = min(max_td, clip.y);
+	float td = clip.x;
+	p += ray * td;
+
+	//March the ray
+	float start_count = march_count;
+	float exit_type = EXIT_MARCHES;
+	float d = de_march(p);
+	march_count += 1.0;
 	float s = 0.0;
-	float td = 0.0;
 	float min_d = 1.0;
-	for (; s < MAX_MARCHES; s += 1.0) {
-		if (d < MIN_DIST) {
-			s += d / MIN_DIST;
+	float omega = iMarchOmega;
+	float step_len = 0.0;
+	float prev_d = 0.0;
+	for (; s < max_marches; s += 1.0) {
+		if (omega > 1.0 && d + prev_d < step_len) {
+			//Unbounding spheres stopped overlapping, step back and stop relaxing
+			td -= step_len - prev_d;
+			p -= ray * (step_len - prev_d);
+			omega = 1.0;
+			step_len = 0.0;
+			d = de_march(p);
+			march_count += 1.0;
+			continue;
+		}
+		if (d < min_dist) {
+			s += d / min_dist;
+			exit_type = EXIT_SURFACE;
 			break;
-		} else if (td > MAX_DIST) {
+		} else if (td > max_td) {
+			exit_type = EXIT_BOUND;
+			break;
+		} else if (sharpness != 1.0 && min_d < SHADOW_CUTOFF) {
+			//The light is already hidden, which sharper shadows find in fewer steps
 			break;
 		}
-		td += d;
-		p += ray * d;
+		step_len = d * omega;
+		prev_d = d;
+		td += step_len;
+		p += ray * step_len;
 		min_d = min(min_d, sharpness * d / td);
-		d = DE(p);
+		d = de_march(p);
+		march_count += 1.0;
+	}
+
+	//Leaving the bounding sphere means nothing else can be hit
+	if (d >= min_dist && td > clip.y) {
+		td = MAX_DIST;
+	}
+
+	//Update the debug counters
+	if (sharpness == 1.0) {
+		view_steps += march_count - start_count;
+		march_exit = exit_type;
+	} else {
+		shadow_steps += march_count - start_count;
 	}
 	return vec4(d, s, td, min_d);
 }
 
 vec4 scene(inout vec4 p, inout vec4 ray, float vignette) {
-	//Trace the ray
-	vec4 d_s_td_m = ray_march(p, ray, 1.0f);
+	//Intersect the marble and flag analytically
+	vec4 obj_col;
+	vec3 obj_n;
+	float obj_td = hit_objects(p.xyz, ray.xyz, obj_col, obj_n);
+	vec4 p0 = p;
+
+	//Trace the ray through the fractal, giving up behind the nearest object
+	vec4 d_s_td_m = ray_march(p, ray, 1.0f, min(obj_td, MAX_DIST));
 	float d = d_s_td_m.x;
 	float s = d_s_td_m.y;
 	float td = d_s_td_m.z;
 	float m = d_s_td_m.w;
+	bool hit_obj = (obj_td < MAX_DIST && (d >= min_dist || td > obj_td));
 
 	//Determine the color for this pixel
 	vec4 col = vec4(0.0);
-	if (d < MIN_DIST) {
-		//Get the surface normal
-		vec4 e = vec4(MIN_DIST, 0.0, 0.0, 0.0);
-		vec3 n = vec3(DE(p + e.xyyy) - DE(p - e.xyyy),
-					  DE(p + e.yxyy) - DE(p - e.yxyy),
-					  DE(p + e.yyxy) - DE(p - e.yyxy));
-		n /= length(n);
+	if (hit_obj || d < min_dist) {
+		vec3 n;
+		vec4 orig_col;
+		if (hit_obj) {
+			//Object normal and coloring are exact
+			p = p0 + ray * obj_td;
+			march_exit = EXIT_OBJECT;
+			td = obj_td;
+			n = obj_n;
+			orig_col = obj_col;
+		} else {
+			//Get the surface normal and coloring
+			vec3 frac_col;
+			n = fractal_normal(p, frac_col);
+			orig_col = vec4(clamp(frac_col, 0.0, 1.0), 0.0);
+		}
 		vec3 reflected = ray.xyz - 2.0*dot(ray.xyz, n) * n;
-
-		//Get coloring
-		vec4 orig_col = clamp(COL(p), 0.0, 1.0);
     col.w = orig_col.w;
+		scene_td = td;
 
 		//Get if this point is in shadow
 		float k = 1.0;
 		#if SHADOWS_ENABLED
 			vec4 light_pt = p;
-			light_pt.xyz += n * MIN_DIST * 100;
-			vec4 rm = ray_march(light_pt, vec4(LIGHT_DIRECTION, 0.0), SHADOW_SHARPNESS);
-      k = rm.w * min(rm.z, 1.0);
+			light_pt.xyz += n * min_dist * 100;
+			vec3 light_org = light_pt.xyz;
+			float texel = 2.0 * iVolume.y / iVolume.x;
+			if (in_volume(light_org) && texel <= pixel_footprint(light_org) * VOLUME_MAX_TEXEL) {
+				//Baked for this level, looked up a texel and a half off the surface, but only
+				//once a texel is no bigger than a pixel so nearby contact shadows are marched
+				k = sample_volume(light_org + n * (3.0 * iVolume.y / iVolume.x)).r;
+			} else {
+				vec4 rm = ray_march(light_pt, vec4(LIGHT_DIRECTION, 0.0), shadow_sharpness, MAX_DIST);
+				k = rm.w * min(rm.z, 1.0);
+			}
+      k = min(k, shadow_objects(light_org, LIGHT_DIRECTION, shadow_sharpness));
 		#endif
 
 		//Get specular
@@ -283,6 +582,7 @@ vec4 scene(inout vec4 p, inout vec4 ray, float vignette) {
 		ray = vec4(n, 0.0);
 	} else {
 		//Ray missed, start with solid background color
+		scene_td = MAX_DIST;
 		col.xyz += BACKGROUND_COLOR;
 
 		col.xyz *= vignette;
@@ -297,52 +597,208 @@ vec4 scene(inout vec4 p, inout vec4 ray, float vignette) {
 	return col;
 }
 
+void probe_axes(vec3 d, out vec3 f, out vec3 u, out float face) {
+	//Face the direction leaves the cube through, must match MarbleProbe::FaceMatrix
+	vec3 a = abs(d);
+	if (a.x >= a.y && a.x >= a.z) {
+		f = vec3(sign(d.x), 0.0, 0.0);
+		u = vec3(0.0, 1.0, 0.0);
+		face = (d.x > 0.0 ? 0.0 : 1.0);
+	} else if (a.y >= a.z) {
+		f = vec3(0.0, sign(d.y), 0.0);
+		u = vec3(0.0, 0.0, sign(d.y));
+		face = (d.y > 0.0 ? 2.0 : 3.0);
+	} else {
+		f = vec3(0.0, 0.0, sign(d.z));
+		u = vec3(0.0, 1.0, 0.0);
+		face = (d.z > 0.0 ? 4.0 : 5.0);
+	}
+}
+
+vec3 sample_probe(vec3 d) {
+	vec3 f;
+	vec3 u;
+	float face;
+	probe_axes(d, f, u, face);
+	vec2 uv = vec2(dot(d, cross(f, u)), dot(d, u)) / dot(d, f);
+
+	//Stay half a texel inside the face so filtering never reaches the next one
+	vec2 px = clamp((uv * 0.5 + 0.5) * iProbeSize, 0.5, iProbeSize - 0.5);
+	vec2 st = (vec2(mod(face, 3.0), floor(face / 3.0)) * iProbeSize + px) / (vec2(3.0, 2.0) * iProbeSize);
+	return texture2D(iProbeTex, st).rgb * PROBE_RANGE;
+}
+
+vec3 probe_face() {
+	//90 degree view from the marble's center, scaled down to keep the sun's highlight
+	vec2 uv = 2.0 * (gl_FragCoord.xy + iTile.xy) / iTile.zw - 1.0;
+	vec4 ray = iMat * normalize(vec4(uv.x, uv.y, -1.0, 0.0));
+	vec4 p = iMat[3];
+	return clamp(scene(p, ray, 0.8).xyz / PROBE_RANGE, 0.0, 1.0);
+}
+
+vec3 render_sample(vec2 delta, out float depth) {
+	//Get normalized screen coordinate
+	vec2 screen_pos = (gl_FragCoord.xy + iTile.xy + delta) / iTile.zw;
+	vec2 uv = 2*screen_pos - 1;
+	uv.x *= iTile.z / iTile.w;
+
+	//Convert screen coordinate to 3d ray
+	vec4 ray = iMat * normalize(vec4(uv.x, uv.y, -FOCAL_DIST, 0.0));
+	vec4 p = iMat[3];
+
+	//Reflect light if needed
+	float vignette = 1.0 - VIGNETTE_STRENGTH * length(screen_pos - 0.5);
+	vec3 r = ray.xyz;
+	vec4 col_r = scene(p, ray, vignette);
+	depth = min(scene_td / MAX_DIST, 1.0);
+	pixel_exit = march_exit;
+
+	//Check if this is the glass marble
+	if (col_r.w > 0.5) {
+		//Calculate refraction
+		vec3 n = normalize(iMarblePos - p.xyz);
+		vec3 q = refraction(r, n, 1.0 / 1.5);
+		vec3 p2 = p.xyz + (dot(q, n) * 2.0 * iMarbleRad) * q;
+		n = normalize(p2 - iMarblePos);
+		q = (dot(q, r) * 2.0) * q - r;
+		vec4 p_temp = vec4(p2 + n * (min_dist * 10), 1.0);
+		vec4 r_temp = vec4(q, 0.0);
+		vec3 refr;
+		if (iProbeSize > 0.0) {
+			refr = sample_probe(q);
+		} else {
+			refr = scene(p_temp, r_temp, 0.8).xyz;
+		}
+
+		//Calculate refraction
+		n = normalize(p.xyz - iMarblePos);
+		q = r - n*(2*dot(r,n));
+		p_temp = vec4(p.xyz + n * (min_dist * 10), 1.0);
+		r_temp = vec4(q, 0.0);
+		vec3 refl;
+		if (iProbeSize > 0.0) {
+			refl = sample_probe(q);
+		} else {
+			refl = scene(p_temp, r_temp, 0.8).xyz;
+		}
+
+		//Combine for final marble color
+		return refr * 0.6f + refl * 0.4f + col_r.xyz;
+	}
+	return col_r.xyz;
+}
+
+vec3 heatmap(float t) {
+	//Blue to green to red
+	t = clamp(t, 0.0, 1.0);
+	return clamp(vec3(t*4.0 - 2.0, 2.0 - abs(t*4.0 - 2.0), 2.0 - t*4.0), 0.0, 1.0);
+}
+
+vec3 exit_color(float e) {
+	if (e == EXIT_SURFACE) { return vec3(0.0, 1.0, 0.0); }
+	if (e == EXIT_OBJECT) { return vec3(1.0, 1.0, 1.0); }
+	if (e == EXIT_BOUND) { return vec3(0.0, 0.0, 1.0); }
+	if (e == EXIT_CLIPPED) { return vec3(0.0, 1.0, 1.0); }
+	return vec3(1.0, 0.0, 0.0);
+}
+
+void debug_output() {
+	//1 = view ray steps, 2 = shadow steps, 3 = all fractal evaluations, 4 = early exit
+	float v = de_calls;
+	if (iDebug.x == 1.0) {
+		v = view_steps;
+	} else if (iDebug.x == 2.0) {
+		v = shadow_steps;
+	} else if (iDebug.x == 4.0) {
+		v = pixel_exit;
+	}
+
+	if (iDebug.y == 1.0) {
+		//Raw 16 bit value for readback
+		gl_FragColor = vec4(floor(v / 256.0) / 255.0, mod(v, 256.0) / 255.0, 0.0, 1.0);
+	} else if (iDebug.x == 4.0) {
+		gl_FragColor = vec4(exit_color(v), 1.0);
+	} else {
+		gl_FragColor = vec4(heatmap(v / iDebug.z), 1.0);
+	}
+}
+
+float luma(vec3 col) {
+	return dot(col, vec3(0.299, 0.587, 0.114));
+}
+
+void detect_edges() {
+	//Largest color or depth jump to the 4 neighbors of the first pass
+	vec2 px = 1.0 / iResolution.xy;
+	vec2 uv = gl_FragCoord.xy * px;
+	vec4 c = texture2D(iAAColor, uv);
+	float contrast = 0.0;
+	for (int i = 0; i < 4; ++i) {
+		vec2 offset = (i < 2 ? vec2(float(i*2 - 1), 0.0) : vec2(0.0, float(i*2 - 5)));
+		vec4 c2 = texture2D(iAAColor, uv + offset * px);
+		contrast = max(contrast, abs(luma(c2.rgb) - luma(c.rgb)));
+		contrast = max(contrast, AA_DEPTH_WEIGHT * abs(c2.a - c.a) / (min(c2.a, c.a) + 0.01));
+	}
+	gl_FragColor = vec4(step(iAAThreshold, contrast), 0.0, 0.0, 1.0);
+}
+
+void refine_edges() {
+	vec2 uv = gl_FragCoord.xy / iResolution.xy;
+	vec3 col = texture2D(iAAColor, uv).rgb;
+
+	//Only refine as many edge pixels as the extra sample budget allows
+	float edge_frac = texture2D(iAAEdges, vec2(0.5), 20.0).r;
+	float keep = iAABudget / (AA_EXTRA_SAMPLES * max(edge_frac, 1e-4));
+	float rnd = fract(sin(dot(gl_FragCoord.xy, vec2(12.9898, 78.233))) * 43758.5453);
+	if (texture2D(iAAEdges, uv).r > 0.5 && rnd < keep) {
+		float depth;
+		col += clamp(render_sample(vec2(0.5, 0.0), depth) * iExposure, 0.0, 1.0);
+		col += clamp(render_sample(vec2(0.0, 0.5), depth) * iExposure, 0.0, 1.0);
+		col += clamp(render_sample(vec2(0.5, 0.5), depth) * iExposure, 0.0, 1.0);
+		col /= AA_EXTRA_SAMPLES + 1.0;
+	}
+	gl_FragColor = vec4(col, 1.0);
+}
+
 void main() {
+	//The quality governor can only coarsen the preset, and surfaces are
+	//resolved finer while exploring deep into the fractal
+	max_marches = min(iMaxMarches, float(MAX_MARCHES));
+	min_dist = max(iMinDist, MIN_DIST) * exp2(-iDeepZoom);
+	shadow_sharpness = max(iShadowSharpness, SHADOW_SHARPNESS);
+
+	//Adaptive anti-aliasing passes
+	if (iAAPass == 2.0) {
+		detect_edges();
+		return;
+	} else if (iAAPass == 3.0) {
+		refine_edges();
+		return;
+	} else if (iAAPass == 4.0) {
+		//A face of the marble's environment probe
+		gl_FragColor = vec4(probe_face(), 1.0);
+		return;
+	}
+
 	vec3 col = vec3(0.0);
+	float depth = 0.0;
 	for (int i = 0; i < ANTIALIASING_SAMPLES; ++i) {
 		for (int j = 0; j < ANTIALIASING_SAMPLES; ++j) {
-			//Get normalized screen coordinate
-      vec2 delta = vec2(i, j) / ANTIALIASING_SAMPLES;
-			vec2 screen_pos = (gl_FragCoord.xy + delta) / iResolution.xy;
-			vec2 uv = 2*screen_pos - 1;
-			uv.x *= iResolution.x / iResolution.y;
-
-			//Convert screen coordinate to 3d ray
-			vec4 ray = iMat * normalize(vec4(uv.x, uv.y, -FOCAL_DIST, 0.0));
-		  vec4 p = iMat[3];
-
-			//Reflect light if needed
-			float vignette = 1.0 - VIGNETTE_STRENGTH * length(screen_pos - 0.5);
-      vec3 r = ray.xyz;
-      vec4 col_r = scene(p, ray, vignette);
-
-      //Check if this is the glass marble
-      if (col_r.w > 0.5) {
-        //Calculate refraction
-        vec3 n = normalize(iMarblePos - p.xyz);
-        vec3 q = refraction(r, n, 1.0 / 1.5);
-        vec3 p2 = p.xyz + (dot(q, n) * 2.0 * iMarbleRad) * q;
-        n = normalize(p2 - iMarblePos);
-        q = (dot(q, r) * 2.0) * q - r;
-        vec4 p_temp = vec4(p2 + n * (MIN_DIST * 10), 1.0);
-        vec4 r_temp = vec4(q, 0.0);
-        vec3 refr = scene(p_temp, r_temp, 0.8).xyz;
-
-        //Calculate refraction
-        n = normalize(p.xyz - iMarblePos);
-        q = r - n*(2*dot(r,n));
-        p_temp = vec4(p.xyz + n * (MIN_DIST * 10), 1.0);
-        r_temp = vec4(q, 0.0);
-        vec3 refl = scene(p_temp, r_temp, 0.8).xyz;
-
-        //Combine for final marble color
-        col += refr * 0.6f + refl * 0.4f + col_r.xyz;
-      } else {
-        col += col_r.xyz;
-      }
+			vec2 delta = vec2(i, j) / ANTIALIASING_SAMPLES + iJitter;
+			col += render_sample(delta, depth);
 		}
 	}
 
 	col *= iExposure / (ANTIALIASING_SAMPLES * ANTIALIASING_SAMPLES);
   gl_FragColor = vec4(clamp(col, 0.0, 1.0), 1.0);
+
+  //The first adaptive anti-aliasing pass keeps depth for edge detection
+  if (iAAPass == 1.0) {
+    gl_FragColor.a = depth;
+  }
+
+  //Replace the color with a debug view
+  if (iDebug.x > 0.0) {
+    debug_output();
+  }
 }
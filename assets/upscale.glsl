@@ -0,0 +1,59 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#version 120
+#define MAX_SHARPEN -0.2
+#define MIN_SHARPEN -0.125
+
+uniform vec2 iResolution;
+uniform sampler2D iSource;
+uniform vec2 iSourceSize;
+uniform vec2 iSourceTexSize;
+uniform float iSharpness;
+uniform sampler2D iHistory;
+uniform float iHistoryWeight;
+
+vec3 source(vec2 px) {
+  //Only read inside the rendered corner of the source texture
+  px = clamp(px, vec2(0.5), iSourceSize - 0.5);
+  return texture2D(iSource, px / iSourceTexSize).rgb;
+}
+
+void main() {
+  vec2 uv = gl_FragCoord.xy / iResolution;
+  vec2 px = uv * iSourceSize;
+
+  //Bilinear sample and its cross neighbors one source pixel away
+  vec3 c = source(px);
+  vec3 n = source(px + vec2(0.0, 1.0));
+  vec3 s = source(px - vec2(0.0, 1.0));
+  vec3 e = source(px + vec2(1.0, 0.0));
+  vec3 w = source(px - vec2(1.0, 0.0));
+
+  //Contrast adaptive sharpening, weaker where the neighborhood is already contrasty
+  vec3 mn = min(c, min(min(n, s), min(e, w)));
+  vec3 mx = max(c, max(max(n, s), max(e, w)));
+  vec3 amp = sqrt(clamp(min(mn, 1.0 - mx) / max(mx, 1e-4), 0.0, 1.0));
+  vec3 k = amp * mix(MIN_SHARPEN, MAX_SHARPEN, iSharpness);
+  vec3 col = clamp((c + (n + s + e + w) * k) / (1.0 + 4.0 * k), 0.0, 1.0);
+
+  //Blend with the previous frame, clamped to the neighborhood to limit ghosting
+  if (iHistoryWeight > 0.0) {
+    vec3 h = clamp(texture2D(iHistory, uv).rgb, mn, mx);
+    col = mix(col, h, iHistoryWeight);
+  }
+  gl_FragColor = vec4(col, 1.0);
+}
@@ -0,0 +1,46 @@
+# Writes one copy of the fragment shader per quality preset, with the preset's
+# #defines replaced the same way ShaderVariants::ApplyPreset does at runtime.
+#
+#   cmake -DSHADER=frag.glsl -DPRESETS=presets.txt -DOUT_DIR=dir
+#         [-DVALIDATOR=glslangValidator] -P ShaderVariants.cmake
+
+file(READ ${SHADER} shader_src)
+file(STRINGS ${PRESETS} preset_lines)
+file(MAKE_DIRECTORY ${OUT_DIR})
+get_filename_component(shader_name ${SHADER} NAME_WE)
+
+foreach(line IN LISTS preset_lines)
+  string(REGEX REPLACE "#.*" "" line "${line}")
+  string(STRIP "${line}" line)
+  if(line STREQUAL "")
+    continue()
+  endif()
+  string(REGEX REPLACE "[ \t]+" ";" fields "${line}")
+  list(GET fields 0 preset)
+  list(REMOVE_AT fields 0)
+
+  set(variant_src "${shader_src}")
+  foreach(define IN LISTS fields)
+    string(REGEX MATCH "^([A-Za-z0-9_]+)=(.*)$" match "${define}")
+    if(NOT match)
+      message(FATAL_ERROR "${PRESETS}: bad define '${define}' in preset ${preset}")
+    endif()
+    set(name ${CMAKE_MATCH_1})
+    set(value ${CMAKE_MATCH_2})
+    if(NOT variant_src MATCHES "(^|\n)#define ${name} ")
+      message(FATAL_ERROR "${SHADER} has no #define ${name} for preset ${preset}")
+    endif()
+    string(REGEX REPLACE "(^|\n)#define ${name} [^\r\n]*" "\\1#define ${name} ${value}" variant_src "${variant_src}")
+  endforeach()
+
+  set(out_file ${OUT_DIR}/${shader_name}_${preset}.glsl)
+  file(WRITE ${out_file} "${variant_src}")
+  message(STATUS "Shader variant: ${out_file}")
+
+  if(VALIDATOR)
+    execute_process(COMMAND ${VALIDATOR} -S frag ${out_file} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "Shader variant ${preset} failed to validate")
+    endif()
+  endif()
+endforeach()
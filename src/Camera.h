@@ -12,6 +12,7 @@ public:
 	    MARBLE,
 	    GOAL,
 	    FINAL,
+	    EXPLORE,
 	    };
     
     Camera() : 
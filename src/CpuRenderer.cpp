@@ -0,0 +1,586 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "CpuRenderer.h"
+#include "FragDefines.h"
+#include "Scene.h"
+#include <algorithm>
+#include <cmath>
+
+typedef CpuRenderer::Packet Packet;
+typedef CpuRenderer::Mask Mask;
+
+//Pixels per packet and per tile, packets are 4x2 blocks
+static const unsigned int packet_w = 4;
+static const unsigned int packet_h = 2;
+static const unsigned int tile_size = 16;
+
+//Positions and directions of 8 rays
+struct RayPacket {
+  Packet px, py, pz;
+  Packet dx, dy, dz;
+  Eigen::Vector3f Pos(int i) const { return Eigen::Vector3f(px[i], py[i], pz[i]); }
+  Eigen::Vector3f Dir(int i) const { return Eigen::Vector3f(dx[i], dy[i], dz[i]); }
+  void Set(int i, const Eigen::Vector3f& p, const Eigen::Vector3f& d) {
+    px[i] = p.x(); py[i] = p.y(); pz[i] = p.z();
+    dx[i] = d.x(); dy[i] = d.y(); dz[i] = d.z();
+  }
+};
+
+//Distance, steps and travelled distance like ray_march() returns
+struct MarchResult {
+  Packet d, s, td;
+};
+
+//Colors of 8 rays, w marks the glass marble
+struct ColorPacket {
+  Packet r, g, b;
+  Mask marble;
+  Eigen::Vector3f Get(int i) const { return Eigen::Vector3f(r[i], g[i], b[i]); }
+  void Set(int i, const Eigen::Vector3f& c) { r[i] = c.x(); g[i] = c.y(); b[i] = c.z(); }
+};
+
+static Packet Select(const Mask& m, const Packet& a, const Packet& b) {
+  return m.select(a, b);
+}
+
+//##########################################
+//   Analytic intersections, see frag.glsl
+//##########################################
+static float HitSphere(const Eigen::Vector3f& ro, const Eigen::Vector3f& rd, const Eigen::Vector3f& c, float r) {
+  const Eigen::Vector3f oc = ro - c;
+  const float b = oc.dot(rd);
+  const float h = b*b - oc.dot(oc) + r*r;
+  if (h < 0.0f) { return -1.0f; }
+  return -b - std::sqrt(h);
+}
+
+static float HitBox(const Eigen::Vector3f& ro, const Eigen::Vector3f& rd, const Eigen::Vector3f& c, const Eigen::Vector3f& s, Eigen::Vector3f& n) {
+  Eigen::Vector3f t1, t2;
+  for (int i = 0; i < 3; ++i) {
+    const float m = 1.0f / (rd[i] == 0.0f ? 1e-10f : rd[i]);
+    const float o = (ro[i] - c[i]) * m;
+    const float k = std::abs(m) * s[i];
+    t1[i] = -o - k;
+    t2[i] = -o + k;
+  }
+  const float tn = t1.maxCoeff();
+  const float tf = t2.minCoeff();
+  if (tn > tf || tn < 0.0f) { return -1.0f; }
+  int axis = 0;
+  t1.maxCoeff(&axis);
+  n.setZero();
+  n[axis] = (rd[axis] > 0.0f ? -1.0f : 1.0f);
+  return tn;
+}
+
+static float HitCapsule(const Eigen::Vector3f& ro, const Eigen::Vector3f& rd, const Eigen::Vector3f& c, float h, float r) {
+  const Eigen::Vector3f pa = c - Eigen::Vector3f(0.0f, h, 0.0f);
+  const Eigen::Vector3f oa = ro - pa;
+  const float baba = 4.0f*h*h;
+  const float bard = 2.0f*h*rd.y();
+  const float baoa = 2.0f*h*oa.y();
+  const float qa = baba - bard*bard;
+  const float qb = baba*rd.dot(oa) - baoa*bard;
+  const float qc = baba*oa.dot(oa) - baoa*baoa - r*r*baba;
+  const float qh = qb*qb - qa*qc;
+  if (qh < 0.0f) { return -1.0f; }
+  const float t = (-qb - std::sqrt(qh)) / qa;
+  const float y = baoa + t*bard;
+  if (y > 0.0f && y < baba) { return t; }
+  return HitSphere(ro, rd, (y <= 0.0f ? pa : c + Eigen::Vector3f(0.0f, h, 0.0f)), r);
+}
+
+static float HitObjects(const CpuRenderer::View& v, const Eigen::Vector3f& ro, const Eigen::Vector3f& rd, Eigen::Vector3f& col, bool& marble, Eigen::Vector3f& n) {
+  float t = max_dist * 2.0f;
+  col.setZero();
+  marble = false;
+  n = Eigen::Vector3f(0.0f, 1.0f, 0.0f);
+
+  const float t_m = HitSphere(ro, rd, v.marble_pos, v.marble_rad);
+  if (t_m > 0.0f && t_m < t) {
+    t = t_m;
+    marble = true;
+    n = (ro + rd*t - v.marble_pos).normalized();
+  }
+
+  Eigen::Vector3f n_box;
+  const Eigen::Vector3f f_pos = v.flag_pos + Eigen::Vector3f(1.5f, 4.0f, 0.0f)*v.flag_scale;
+  const float t_b = HitBox(ro, rd, f_pos, Eigen::Vector3f(1.5f, 0.8f, 0.08f)*v.marble_rad, n_box);
+  if (t_b > 0.0f && t_b < t) {
+    t = t_b;
+    col = Eigen::Vector3f(1.0f, 0.2f, 0.1f);
+    marble = false;
+    n = n_box;
+  }
+
+  const Eigen::Vector3f c_pos = v.flag_pos + Eigen::Vector3f(0.0f, v.flag_scale*2.4f, 0.0f);
+  const float t_c = HitCapsule(ro, rd, c_pos, v.marble_rad*2.4f, v.marble_rad*0.18f);
+  if (t_c > 0.0f && t_c < t) {
+    t = t_c;
+    col = Eigen::Vector3f(0.9f, 0.9f, 0.1f);
+    marble = false;
+    Eigen::Vector3f q = ro + rd*t - c_pos;
+    q.y() -= std::min(std::max(q.y(), -v.marble_rad*2.4f), v.marble_rad*2.4f);
+    n = q.normalized();
+  }
+  return t;
+}
+
+static float ShadowObjects(const CpuRenderer::View& v, const Eigen::Vector3f& ro, const Eigen::Vector3f& rd, float sharpness) {
+  Eigen::Vector3f n_box;
+  const Eigen::Vector3f f_pos = v.flag_pos + Eigen::Vector3f(1.5f, 4.0f, 0.0f)*v.flag_scale;
+  if (HitBox(ro, rd, f_pos, Eigen::Vector3f(1.5f, 0.8f, 0.08f)*v.marble_rad, n_box) > 0.0f ||
+      HitCapsule(ro, rd, v.flag_pos + Eigen::Vector3f(0.0f, v.flag_scale*2.4f, 0.0f), v.marble_rad*2.4f, v.marble_rad*0.18f) > 0.0f) {
+    return 0.0f;
+  }
+  const Eigen::Vector3f oc = v.marble_pos - ro;
+  const float t = oc.dot(rd);
+  if (t <= 0.0f) { return 1.0f; }
+  const float d = (oc - rd*t).norm() - v.marble_rad;
+  return std::min(std::max(sharpness * d / t, 0.0f), 1.0f);
+}
+
+//##########################################
+//   Marching, see ray_march() in frag.glsl
+//##########################################
+static MarchResult RayMarch(const Scene& scene, const CpuRenderer::View& v, RayPacket& r, const Packet& max_td_in, const Mask& active) {
+  MarchResult res;
+  res.d.setConstant(max_dist);
+  res.s.setZero();
+  res.td.setConstant(max_dist);
+
+  //Skip straight to the bounding sphere, or give up if it is missed
+  const Packet b = r.px*r.dx + r.py*r.dy + r.pz*r.dz;
+  const Packet h = b*b - (r.px*r.px + r.py*r.py + r.pz*r.pz) + v.frac_bound*v.frac_bound;
+  const Packet hs = h.max(0.0f).sqrt();
+  const Mask hit_bound = (h >= 0.0f);
+  const Packet clip_x = Select(hit_bound, (-b - hs).max(0.0f), Packet::Constant(max_dist));
+  const Packet clip_y = Select(hit_bound, -b + hs, Packet::Constant(-1.0f));
+  const Mask live = active && (clip_x <= clip_y.min(max_td_in));
+  if (!live.any()) {
+    return res;
+  }
+  const Packet max_td = max_td_in.min(clip_y);
+  Packet td = Select(live, clip_x, Packet::Zero());
+  r.px += r.dx*td; r.py += r.dy*td; r.pz += r.dz*td;
+
+  Packet d = scene.DE(r.px, r.py, r.pz);
+
+  Packet s = Packet::Zero();
+  Packet omega = Packet::Constant(v.march_omega);
+  Packet step_len = Packet::Zero();
+  Packet prev_d = Packet::Zero();
+  Mask running = live;
+  for (int iter = 0; iter < max_march_steps && running.any(); ++iter) {
+    //Unbounding spheres stopped overlapping, step back and stop relaxing
+    const Mask back = running && (omega > 1.0f) && (d + prev_d < step_len);
+    const Packet back_len = Select(back, step_len - prev_d, Packet::Zero());
+    td -= back_len;
+    r.px -= r.dx*back_len; r.py -= r.dy*back_len; r.pz -= r.dz*back_len;
+    omega = Select(back, Packet::Ones(), omega);
+    step_len = Select(back, Packet::Zero(), step_len);
+
+    const Mask surface = running && !back && (d < min_dist);
+    s = Select(surface, s + d / min_dist, s);
+    const Mask bound = running && !back && !surface && (td > max_td);
+    running = running && !surface && !bound;
+
+    const Mask advance = running && !back;
+    step_len = Select(advance, d * omega, step_len);
+    prev_d = Select(advance, d, prev_d);
+    const Packet step = Select(advance, step_len, Packet::Zero());
+    td += step;
+    r.px += r.dx*step; r.py += r.dy*step; r.pz += r.dz*step;
+    s = Select(running, s + 1.0f, s);
+
+    d = Select(running, scene.DE(r.px, r.py, r.pz), d);
+  }
+
+  //Leaving the bounding sphere means nothing else can be hit
+  td = Select(d >= min_dist && td > clip_y, Packet::Constant(max_dist), td);
+  res.d = Select(live, d, res.d);
+  res.s = Select(live, s, res.s);
+  res.td = Select(live, td, res.td);
+  return res;
+}
+
+Packet CpuRenderer::MarchShadow(const FractalParams& params, float bound, float omega_in,
+                                Packet px, Packet py, Packet pz, const Mask& active) {
+  //Clipped to the bounding sphere the same way as RayMarch
+  const Packet b = px*light_dir.x() + py*light_dir.y() + pz*light_dir.z();
+  const Packet h = b*b - (px*px + py*py + pz*pz) + bound*bound;
+  const Packet hs = h.max(0.0f).sqrt();
+  const Mask hit_bound = (h >= 0.0f);
+  const Packet clip_x = Select(hit_bound, (-b - hs).max(0.0f), Packet::Constant(max_dist));
+  const Packet clip_y = Select(hit_bound, -b + hs, Packet::Constant(-1.0f));
+  const Mask live = active && (clip_x <= clip_y.min(max_dist));
+  if (!live.any()) {
+    return Packet::Ones();
+  }
+  const Packet max_td = clip_y.min(max_dist);
+  Packet td = Select(live, clip_x, Packet::Zero());
+  px += light_dir.x()*td; py += light_dir.y()*td; pz += light_dir.z()*td;
+
+  Packet d = Scene::DE(params, px, py, pz);
+  Packet min_d = Packet::Ones();
+  Packet omega = Packet::Constant(omega_in);
+  Packet step_len = Packet::Zero();
+  Packet prev_d = Packet::Zero();
+  Mask running = live;
+  for (int iter = 0; iter < max_march_steps && running.any(); ++iter) {
+    //Overrelaxed steps are undone as in RayMarch
+    const Mask back = running && (omega > 1.0f) && (d + prev_d < step_len);
+    const Packet back_len = Select(back, step_len - prev_d, Packet::Zero());
+    td -= back_len;
+    px -= light_dir.x()*back_len; py -= light_dir.y()*back_len; pz -= light_dir.z()*back_len;
+    omega = Select(back, Packet::Ones(), omega);
+    step_len = Select(back, Packet::Zero(), step_len);
+
+    //Hitting the surface, leaving the bound, or the light already being hidden
+    const Mask done = running && !back && ((d < min_dist) || (td > max_td) || (min_d < shadow_cutoff));
+    running = running && !done;
+
+    const Mask advance = running && !back;
+    step_len = Select(advance, d * omega, step_len);
+    prev_d = Select(advance, d, prev_d);
+    const Packet step = Select(advance, step_len, Packet::Zero());
+    td += step;
+    px += light_dir.x()*step; py += light_dir.y()*step; pz += light_dir.z()*step;
+    min_d = Select(advance, min_d.min(shadow_sharpness * d / td), min_d);
+
+    d = Select(running, Scene::DE(params, px, py, pz), d);
+  }
+
+  //Past the bounding sphere the light is unobstructed
+  td = Select(d >= min_dist && td > clip_y, Packet::Constant(max_dist), td);
+  return Select(live, min_d * td.min(1.0f), Packet::Ones());
+}
+
+//##########################################
+//   Shading, see scene() in frag.glsl
+//##########################################
+static ColorPacket ShadeScene(const Scene& scene, const CpuRenderer::View& v, bool shadows, RayPacket& r, const Packet& vignette, const Mask& active) {
+  ColorPacket col;
+  col.r.setZero(); col.g.setZero(); col.b.setZero();
+  col.marble.setConstant(false);
+
+  //Intersect the marble and flag analytically
+  Packet obj_td;
+  Eigen::Vector3f obj_col[8], obj_n[8];
+  bool obj_marble[8];
+  for (int i = 0; i < 8; ++i) {
+    obj_td[i] = (active[i] ? HitObjects(v, r.Pos(i), r.Dir(i), obj_col[i], obj_marble[i], obj_n[i]) : max_dist * 2.0f);
+  }
+  const RayPacket r0 = r;
+
+  //Trace the ray through the fractal, giving up behind the nearest object
+  const MarchResult m = RayMarch(scene, v, r, obj_td.min(max_dist), active);
+  const Mask hit_obj = active && (obj_td < max_dist) && ((m.d >= min_dist) || (m.td > obj_td));
+  const Mask hit_frac = active && !hit_obj && (m.d < min_dist);
+
+  //Fractal normals from a tetrahedron of samples
+  Packet nx = Packet::Zero(), ny = Packet::Zero(), nz = Packet::Zero();
+  if (hit_frac.any()) {
+    const Packet d0 = scene.DE(r.px + min_dist, r.py - min_dist, r.pz - min_dist);
+    const Packet d1 = scene.DE(r.px - min_dist, r.py - min_dist, r.pz + min_dist);
+    const Packet d2 = scene.DE(r.px - min_dist, r.py + min_dist, r.pz - min_dist);
+    const Packet d3 = scene.DE(r.px + min_dist, r.py + min_dist, r.pz + min_dist);
+    nx = d0 - d1 - d2 + d3;
+    ny = -d0 - d1 + d2 + d3;
+    nz = -d0 + d1 - d2 + d3;
+    const Packet len = (nx*nx + ny*ny + nz*nz).sqrt().max(1e-20f);
+    nx /= len; ny /= len; nz /= len;
+  }
+
+  //Surface points, normals and base colors
+  Eigen::Vector3f base[8];
+  for (int i = 0; i < 8; ++i) {
+    if (hit_obj[i]) {
+      const Eigen::Vector3f p = r0.Pos(i) + r0.Dir(i) * obj_td[i];
+      r.Set(i, p, obj_n[i]);
+      base[i] = obj_col[i];
+      col.marble[i] = obj_marble[i];
+    } else if (hit_frac[i]) {
+      const Eigen::Vector3f p = r.Pos(i);
+      r.Set(i, p, Eigen::Vector3f(nx[i], ny[i], nz[i]));
+      base[i] = scene.FractalColor(p).cwiseMax(0.0f).cwiseMin(1.0f);
+    }
+  }
+  const Mask lit = hit_obj || hit_frac;
+
+  //Get if the points are in shadow
+  Packet k = Packet::Ones();
+  if (shadows && lit.any()) {
+    const Packet lx = r.px + r.dx * (min_dist * 100.0f);
+    const Packet ly = r.py + r.dy * (min_dist * 100.0f);
+    const Packet lz = r.pz + r.dz * (min_dist * 100.0f);
+    k = CpuRenderer::MarchShadow(scene.GetFractalParams(), v.frac_bound, v.march_omega, lx, ly, lz, lit);
+    for (int i = 0; i < 8; ++i) {
+      if (lit[i]) {
+        k[i] = std::min(k[i], ShadowObjects(v, Eigen::Vector3f(lx[i], ly[i], lz[i]), light_dir, shadow_sharpness));
+      }
+    }
+  }
+
+  for (int i = 0; i < 8; ++i) {
+    if (!active[i]) {
+      continue;
+    }
+    Eigen::Vector3f c = Eigen::Vector3f::Zero();
+    if (lit[i]) {
+      const Eigen::Vector3f n = r.Dir(i);
+      const Eigen::Vector3f rd = r0.Dir(i);
+      const Eigen::Vector3f reflected = rd - 2.0f*rd.dot(n) * n;
+      float ki = k[i];
+
+      //Specular, enhanced diffuse, and never entirely dark shadows
+      const float specular = std::pow(std::max(reflected.dot(light_dir), 0.0f), specular_highlight);
+      c += specular * light_color * (ki * specular_mult);
+      ki = std::min(ki, shadow_darkness * 0.5f * (n.dot(light_dir) - 1.0f) + 1.0f);
+      ki = std::max(ki, 1.0f - shadow_darkness);
+      c += base[i].cwiseProduct(light_color) * ki;
+
+      //Small amount of ambient occlusion
+      const float a = 1.0f / (1.0f + m.s[i] * ambient_occlusion_strength);
+      c += (1.0f - a) * ambient_occlusion_delta;
+    } else {
+      //Background with a sun
+      const Eigen::Vector3f rd = r0.Dir(i);
+      c = background_color * vignette[i];
+      const float sun_spec = rd.dot(light_dir) - 1.0f + sun_size;
+      c += light_color * std::min(std::exp(sun_spec * sun_sharpness / sun_size), 1.0f);
+    }
+    col.Set(i, c);
+  }
+  return col;
+}
+
+static Eigen::Vector3f Refraction(const Eigen::Vector3f& rd, const Eigen::Vector3f& n, float p) {
+  const float dot_nd = rd.dot(n);
+  return p * (rd - dot_nd * n) + std::sqrt(1.0f - (p * p) * (1.0f - dot_nd * dot_nd)) * n;
+}
+
+//Colors of a 4x2 block of pixels, see render_sample() in frag.glsl
+static ColorPacket RenderPacket(const Scene& scene, const CpuRenderer::View& v, bool shadows, const Packet& sx, const Packet& sy, float aspect, const Mask& active) {
+  RayPacket r;
+  Packet vignette;
+  for (int i = 0; i < 8; ++i) {
+    const float ux = (2.0f*sx[i] - 1.0f) * aspect;
+    const float uy = 2.0f*sy[i] - 1.0f;
+    const Eigen::Vector4f ray = v.mat * Eigen::Vector4f(ux, uy, -focal_dist, 0.0f).normalized();
+    r.Set(i, v.mat.block<3, 1>(0, 3), ray.head<3>());
+    vignette[i] = 1.0f - vignette_strength * Eigen::Vector2f(sx[i] - 0.5f, sy[i] - 0.5f).norm();
+  }
+  const RayPacket r_view = r;
+  ColorPacket col = ShadeScene(scene, v, shadows, r, vignette, active);
+
+  //Glass marble refracts and reflects
+  const Mask marble = active && col.marble;
+  if (!marble.any()) {
+    return col;
+  }
+  RayPacket refr_ray, refl_ray;
+  refr_ray = refl_ray = r;
+  for (int i = 0; i < 8; ++i) {
+    if (!marble[i]) {
+      continue;
+    }
+    const Eigen::Vector3f p = r.Pos(i);
+    const Eigen::Vector3f rd = r_view.Dir(i);
+    Eigen::Vector3f n = (v.marble_pos - p).normalized();
+    Eigen::Vector3f q = Refraction(rd, n, 1.0f / 1.5f);
+    const Eigen::Vector3f p2 = p + (q.dot(n) * 2.0f * v.marble_rad) * q;
+    n = (p2 - v.marble_pos).normalized();
+    q = (q.dot(rd) * 2.0f) * q - rd;
+    refr_ray.Set(i, p2 + n * (min_dist * 10.0f), q);
+
+    n = (p - v.marble_pos).normalized();
+    q = rd - n*(2.0f*rd.dot(n));
+    refl_ray.Set(i, p + n * (min_dist * 10.0f), q);
+  }
+  const Packet inner_vignette = Packet::Constant(0.8f);
+  const ColorPacket refr = ShadeScene(scene, v, shadows, refr_ray, inner_vignette, marble);
+  const ColorPacket refl = ShadeScene(scene, v, shadows, refl_ray, inner_vignette, marble);
+  col.r = Select(marble, refr.r*0.6f + refl.r*0.4f + col.r, col.r);
+  col.g = Select(marble, refr.g*0.6f + refl.g*0.4f + col.g, col.g);
+  col.b = Select(marble, refr.b*0.6f + refl.b*0.4f + col.b, col.b);
+  return col;
+}
+
+//##########################################
+//   Threads
+//##########################################
+CpuRenderer::CpuRenderer(int num_threads) :
+  shadows(true),
+  scene(nullptr),
+  width(0),
+  height(0),
+  tiles_x(0),
+  pixels(nullptr),
+  frame_id(0),
+  busy(0),
+  quit(false) {
+  if (num_threads <= 0) {
+    num_threads = std::max(int(std::thread::hardware_concurrency()), 1);
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    queues.push_back(std::unique_ptr<TileQueue>(new TileQueue));
+  }
+  //The calling thread renders too, as thread 0
+  for (int i = 1; i < num_threads; ++i) {
+    workers.push_back(std::thread(&CpuRenderer::WorkerLoop, this, i));
+  }
+}
+
+CpuRenderer::~CpuRenderer() {
+  {
+    std::unique_lock<std::mutex> lock(frame_mutex);
+    quit = true;
+  }
+  frame_cv.notify_all();
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+}
+
+void CpuRenderer::Render(const Scene& _scene, unsigned int _width, unsigned int _height, std::vector<unsigned char>& rgba) {
+  //Read everything the shader would get
+  const UniformBlock& uniforms = _scene.GetUniforms();
+  view.mat = Eigen::Map<const Eigen::Matrix4f>(uniforms.Find("iMat"));
+  view.marble_pos = Eigen::Map<const Eigen::Vector3f>(uniforms.Find("iMarblePos"));
+  view.marble_rad = *uniforms.Find("iMarbleRad");
+  view.flag_pos = Eigen::Map<const Eigen::Vector3f>(uniforms.Find("iFlagPos"));
+  view.flag_scale = *uniforms.Find("iFlagScale");
+  view.frac_bound = *uniforms.Find("iFracBound");
+  view.march_omega = *uniforms.Find("iMarchOmega");
+  view.exposure = *uniforms.Find("iExposure");
+
+  //The explorer sends positions relative to its origin, put them back in world space
+  const Eigen::Vector3f origin =
+    Eigen::Map<const Eigen::Vector3f>(uniforms.Find("iOrigin")) +
+    Eigen::Map<const Eigen::Vector3f>(uniforms.Find("iOriginLow"));
+  view.mat.block<3, 1>(0, 3) += origin;
+  view.marble_pos += origin;
+  view.flag_pos += origin;
+
+  scene = &_scene;
+  width = _width;
+  height = _height;
+  rgba.resize(size_t(width) * size_t(height) * 4);
+  pixels = rgba.data();
+
+  //Each thread starts with a contiguous band of tiles
+  tiles_x = (width + tile_size - 1) / tile_size;
+  const int num_tiles = int(tiles_x * ((height + tile_size - 1) / tile_size));
+  const int num_queues = int(queues.size());
+  for (int i = 0; i < num_queues; ++i) {
+    std::unique_lock<std::mutex> lock(queues[i]->mutex);
+    for (int t = num_tiles * i / num_queues; t < num_tiles * (i + 1) / num_queues; ++t) {
+      queues[i]->tiles.push_back(t);
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(frame_mutex);
+    frame_id += 1;
+    busy = int(workers.size());
+  }
+  frame_cv.notify_all();
+  RenderTiles(0);
+  std::unique_lock<std::mutex> lock(frame_mutex);
+  done_cv.wait(lock, [this] { return busy == 0; });
+}
+
+void CpuRenderer::WorkerLoop(int ix) {
+  int last_frame = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(frame_mutex);
+      frame_cv.wait(lock, [&] { return quit || frame_id != last_frame; });
+      if (quit) {
+        return;
+      }
+      last_frame = frame_id;
+    }
+    RenderTiles(ix);
+    {
+      std::unique_lock<std::mutex> lock(frame_mutex);
+      busy -= 1;
+    }
+    done_cv.notify_one();
+  }
+}
+
+void CpuRenderer::RenderTiles(int ix) {
+  int tile = 0;
+  while (NextTile(ix, tile)) {
+    RenderTile(tile);
+  }
+}
+
+bool CpuRenderer::NextTile(int ix, int& tile) {
+  //Own tiles from the front, stolen ones from the back of the others
+  const int num_queues = int(queues.size());
+  for (int i = 0; i < num_queues; ++i) {
+    TileQueue& queue = *queues[(ix + i) % num_queues];
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    if (queue.tiles.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      tile = queue.tiles.front();
+      queue.tiles.pop_front();
+    } else {
+      tile = queue.tiles.back();
+      queue.tiles.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+void CpuRenderer::RenderTile(int tile) {
+  const unsigned int x0 = (unsigned int)(tile % tiles_x) * tile_size;
+  const unsigned int y0 = (unsigned int)(tile / tiles_x) * tile_size;
+  const float aspect = float(width) / float(height);
+  for (unsigned int py = y0; py < std::min(y0 + tile_size, height); py += packet_h) {
+    for (unsigned int px = x0; px < std::min(x0 + tile_size, width); px += packet_w) {
+      //Screen positions of the pixel centers, gl_FragCoord counts from the bottom
+      Packet sx, sy;
+      Mask active;
+      for (int i = 0; i < 8; ++i) {
+        const unsigned int x = px + i % packet_w;
+        const unsigned int y = py + i / packet_w;
+        active[i] = (x < width && y < height);
+        sx[i] = (float(x) + 0.5f) / float(width);
+        sy[i] = (float(height - y) - 0.5f) / float(height);
+      }
+      const ColorPacket col = RenderPacket(*scene, view, shadows, sx, sy, aspect, active);
+      for (int i = 0; i < 8; ++i) {
+        if (!active[i]) {
+          continue;
+        }
+        const Eigen::Vector3f c = (col.Get(i) * view.exposure).cwiseMax(0.0f).cwiseMin(1.0f);
+        unsigned char* dst = &pixels[(size_t(py + i / packet_w) * width + px + i % packet_w) * 4];
+        dst[0] = (unsigned char)(c.x() * 255.0f + 0.5f);
+        dst[1] = (unsigned char)(c.y() * 255.0f + 0.5f);
+        dst[2] = (unsigned char)(c.z() * 255.0f + 0.5f);
+        dst[3] = 255;
+      }
+    }
+  }
+}
@@ -0,0 +1,95 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "Level.h"
+#include <Eigen/Dense>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Scene;
+
+//Software port of frag.glsl for machines without shader support. Rays are
+//marched in packets through Scene's distance estimator, and tiles are shared
+//between threads that steal from each other once their own queue is empty.
+class CpuRenderer {
+public:
+  //Eight lanes like Scene::Packet
+  typedef Eigen::Array<float, 8, 1> Packet;
+  typedef Eigen::Array<bool, 8, 1> Mask;
+
+  //0 uses one thread per core
+  CpuRenderer(int num_threads=0);
+  ~CpuRenderer();
+
+  //Renders the view the scene would send to the shader, RGBA with the top row first
+  void Render(const Scene& scene, unsigned int width, unsigned int height, std::vector<unsigned char>& rgba);
+
+  void SetShadows(bool enabled) { shadows = enabled; }
+  bool IsShadows() const { return shadows; }
+  int NumThreads() const { return int(queues.size()); }
+
+  //Light visibility at 8 points from the shadow ray in scene(), 1 for lanes that aren't active.
+  //Also bakes LevelVolume, so both stay in step with frag.glsl.
+  static Packet MarchShadow(const FractalParams& params, float bound, float omega,
+                            Packet px, Packet py, Packet pz, const Mask& active);
+
+  //The uniforms the renderer reads from the scene
+  struct View {
+    Eigen::Matrix4f mat;
+    Eigen::Vector3f marble_pos;
+    float marble_rad;
+    Eigen::Vector3f flag_pos;
+    float flag_scale;
+    float frac_bound;
+    float march_omega;
+    float exposure;
+  };
+
+private:
+  struct TileQueue {
+    std::mutex mutex;
+    std::deque<int> tiles;
+  };
+
+  void WorkerLoop(int ix);
+  void RenderTiles(int ix);
+  bool NextTile(int ix, int& tile);
+  void RenderTile(int tile);
+
+  bool shadows;
+
+  //Current frame, only written while the workers are idle
+  const Scene* scene;
+  View view;
+  unsigned int width;
+  unsigned int height;
+  unsigned int tiles_x;
+  unsigned char* pixels;
+
+  std::vector<std::unique_ptr<TileQueue>> queues;
+  std::vector<std::thread> workers;
+  std::mutex frame_mutex;
+  std::condition_variable frame_cv;
+  std::condition_variable done_cv;
+  int frame_id;
+  int busy;
+  bool quit;
+};
@@ -0,0 +1,56 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DynamicRes.h"
+#include <algorithm>
+#include <cmath>
+
+//No change while the smoothed time is within this band around the target
+static const float band_low = 0.85f;
+static const float band_high = 1.05f;
+//Largest and smallest change to the scale per step
+static const float max_step = 0.1f;
+static const float min_step = 0.02f;
+
+DynamicRes::DynamicRes(float _target_ms, float _min_scale, float _max_scale) :
+  filter(_target_ms, band_low, band_high),
+  min_scale(_min_scale),
+  max_scale(_max_scale),
+  scale(_max_scale) {
+}
+
+float DynamicRes::Update(float frame_ms) {
+  //Hold while settling or close enough to the target
+  if (!filter.Update(frame_ms) || (!filter.IsOver() && !filter.IsUnder())) {
+    return scale;
+  }
+  const float ratio = filter.GetRatio();
+
+  //Shading cost grows with the pixel count, the square of the scale
+  const float ideal = scale / std::sqrt(std::max(ratio, 1e-3f));
+  const float step = std::min(std::max(ideal - scale, -max_step), max_step);
+  const float new_scale = std::min(std::max(scale + step, min_scale), max_scale);
+  if (std::abs(new_scale - scale) >= min_step) {
+    scale = new_scale;
+    filter.Settle();
+  }
+  return scale;
+}
+
+void DynamicRes::Reset(float s) {
+  scale = std::min(std::max(s, min_scale), max_scale);
+  filter.Reset();
+}
@@ -0,0 +1,38 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "FrameTimeFilter.h"
+
+//Chooses the internal render scale from measured frame times
+class DynamicRes {
+public:
+  DynamicRes(float _target_ms, float _min_scale, float _max_scale);
+
+  //Feed the render time of the last frame, returns the scale for the next one
+  float Update(float frame_ms);
+  void Reset(float scale);
+
+  float GetScale() const { return scale; }
+  float GetTarget() const { return filter.GetTarget(); }
+  float GetSmoothTime() const { return filter.GetSmoothTime(); }
+
+private:
+  FrameTimeFilter filter;
+  float min_scale;
+  float max_scale;
+  float scale;
+};
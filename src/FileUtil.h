@@ -0,0 +1,30 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Config.hpp>
+#include <cstddef>
+#include <string>
+
+//Helpers for the directories and cache files kept next to the saves
+class FileUtil {
+public:
+  //True once the directory exists, whether or not it was just made
+  static bool CreateDir(const std::string& path);
+
+  //FNV-1a over raw bytes, pass the previous result on to hash several blocks
+  static sf::Uint32 Hash(const void* data, size_t size, sf::Uint32 hash=2166136261u);
+};
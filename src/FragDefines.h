@@ -0,0 +1,38 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <Eigen/Dense>
+
+//Defines from frag.glsl for the CPU ports of its marching and shading,
+//at the low preset's march settings
+static const float focal_dist = 1.73205080757f;
+static const float max_dist = 30.0f;
+static const int max_march_steps = 300;
+static const float min_dist = 1e-4f;
+static const float shadow_cutoff = 0.02f;
+static const float shadow_darkness = 0.7f;
+static const float shadow_sharpness = 10.0f;
+static const float specular_highlight = 40.0f;
+static const float specular_mult = 0.25f;
+static const float sun_sharpness = 2.0f;
+static const float sun_size = 0.004f;
+static const float vignette_strength = 0.5f;
+static const float ambient_occlusion_strength = 0.008f;
+static const Eigen::Vector3f ambient_occlusion_delta(0.7f, 0.7f, 0.7f);
+static const Eigen::Vector3f background_color(0.6f, 0.8f, 1.0f);
+static const Eigen::Vector3f light_color(1.0f, 0.95f, 0.8f);
+static const Eigen::Vector3f light_dir(-0.36f, 0.8f, 0.48f);
@@ -0,0 +1,322 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "FrameCapture.h"
+#include "GLExt.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+FrameCapture::FrameCapture() :
+  use_pbo(false),
+  blocking(false),
+  slot_ix(0),
+  dropped(0),
+  max_jobs(0),
+  busy(0),
+  quit(false) {
+  for (int i = 0; i < num_slots; ++i) {
+    slots[i].pbo = 0;
+    slots[i].pending = false;
+    slots[i].age = 0;
+  }
+}
+
+FrameCapture::~FrameCapture() {
+  {
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+    quit = true;
+  }
+  jobs_cv.notify_all();
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+}
+
+void FrameCapture::Init() {
+  GLExt::Load();
+  use_pbo = GLExt::HasPixelBuffer();
+  if (use_pbo) {
+    for (int i = 0; i < num_slots; ++i) {
+      GLExt::GenBuffers(1, &slots[i].pbo);
+    }
+  }
+}
+
+void FrameCapture::Capture(sf::RenderTarget& target, const std::string& fname, Format format, int downsample) {
+  StartWorkers();
+  target.setActive(true);
+  Slot& slot = slots[slot_ix];
+  if (slot.pending && blocking) {
+    ReadSlot(slot);
+  } else if (slot.pending) {
+    //Every buffer is still in flight, skip rather than stall
+    dropped += 1;
+    return;
+  }
+
+  Job& job = slot.job;
+  job.width = target.getSize().x;
+  job.height = target.getSize().y;
+  job.fname = fname;
+  job.format = format;
+  job.downsample = std::max(downsample, 1);
+  job.top_down = false;
+  const size_t num_bytes = size_t(job.width) * size_t(job.height) * 4;
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  if (use_pbo) {
+    //Starts an asynchronous copy into the pixel buffer
+    GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    GLExt::BufferData(GL_PIXEL_PACK_BUFFER, std::ptrdiff_t(num_bytes), nullptr, GL_STREAM_READ);
+    glReadPixels(0, 0, job.width, job.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.pending = true;
+    slot.age = 0;
+    slot_ix = (slot_ix + 1) % num_slots;
+  } else {
+    job.pixels.resize(num_bytes);
+    glReadPixels(0, 0, job.width, job.height, GL_RGBA, GL_UNSIGNED_BYTE, job.pixels.data());
+    Push(job);
+  }
+}
+
+void FrameCapture::Update() {
+  //Map buffers only once the GPU has had a few frames to finish the copy
+  for (int i = 0; i < num_slots; ++i) {
+    Slot& slot = slots[i];
+    if (slot.pending && ++slot.age >= num_slots - 1) {
+      ReadSlot(slot);
+    }
+  }
+}
+
+void FrameCapture::Save(std::vector<unsigned char>& rgba, unsigned int width, unsigned int height, const std::string& fname, Format format) {
+  StartWorkers();
+  Job job;
+  job.pixels.swap(rgba);
+  job.width = width;
+  job.height = height;
+  job.fname = fname;
+  job.format = format;
+  job.downsample = 1;
+  job.top_down = true;
+  Push(job);
+}
+
+void FrameCapture::Flush() {
+  {
+    //The window may already be closed, buffers are shared with any new context
+    sf::Context context;
+    for (int i = 0; i < num_slots; ++i) {
+      if (slots[i].pending) {
+        ReadSlot(slots[i]);
+      }
+    }
+  }
+  std::unique_lock<std::mutex> lock(jobs_mutex);
+  done_cv.wait(lock, [this] { return jobs.empty() && busy == 0; });
+}
+
+void FrameCapture::StartWorkers() {
+  //Most sessions never capture anything, so the encoders wait for the first frame
+  if (!workers.empty()) {
+    return;
+  }
+  //Leave one core for the game itself
+  const unsigned int num_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  max_jobs = num_workers * 4;
+  for (unsigned int i = 0; i < num_workers; ++i) {
+    workers.push_back(std::thread(&FrameCapture::WorkerLoop, this));
+  }
+}
+
+void FrameCapture::ReadSlot(Slot& slot) {
+  Job& job = slot.job;
+  job.pixels.resize(size_t(job.width) * size_t(job.height) * 4);
+  GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  const void* data = GLExt::MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  if (data) {
+    std::memcpy(job.pixels.data(), data, job.pixels.size());
+    GLExt::UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    Push(job);
+  } else {
+    dropped += 1;
+  }
+  GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.pending = false;
+}
+
+void FrameCapture::Push(Job& job) {
+  {
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+    if (blocking) {
+      done_cv.wait(lock, [this] { return jobs.size() < max_jobs; });
+    } else if (jobs.size() >= max_jobs) {
+      //Encoders can't keep up, drop the frame instead of the frame rate
+      dropped += 1;
+      return;
+    }
+    jobs.push_back(Job());
+    std::swap(jobs.back(), job);
+  }
+  jobs_cv.notify_one();
+}
+
+void FrameCapture::WorkerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(jobs_mutex);
+      jobs_cv.wait(lock, [this] { return quit || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      std::swap(job, jobs.front());
+      jobs.pop_front();
+      busy += 1;
+    }
+    Encode(job);
+    {
+      std::unique_lock<std::mutex> lock(jobs_mutex);
+      busy -= 1;
+    }
+    done_cv.notify_all();
+  }
+}
+
+void FrameCapture::Encode(Job& job) {
+  //OpenGL rows start at the bottom
+  if (!job.top_down) {
+    const size_t row_bytes = size_t(job.width) * 4;
+    std::vector<unsigned char> row(row_bytes);
+    for (unsigned int y = 0; y < job.height / 2; ++y) {
+      unsigned char* top = &job.pixels[y * row_bytes];
+      unsigned char* bottom = &job.pixels[(job.height - 1 - y) * row_bytes];
+      std::memcpy(row.data(), top, row_bytes);
+      std::memcpy(top, bottom, row_bytes);
+      std::memcpy(bottom, row.data(), row_bytes);
+    }
+  }
+  for (size_t i = 3; i < job.pixels.size(); i += 4) {
+    job.pixels[i] = 255;
+  }
+  Downsample(job.pixels, job.width, job.height, job.downsample);
+
+  bool success = false;
+  if (job.format == QOI) {
+    const std::vector<unsigned char> qoi = EncodeQOI(job.pixels.data(), job.width, job.height);
+    std::ofstream fout(job.fname, std::ios::binary);
+    fout.write((const char*)qoi.data(), qoi.size());
+    success = bool(fout);
+  } else {
+    sf::Image image;
+    image.create(job.width, job.height, job.pixels.data());
+    success = image.saveToFile(job.fname);
+  }
+  if (!success) {
+    std::cerr << "Failed to save " << job.fname << std::endl;
+  }
+}
+
+void FrameCapture::Downsample(std::vector<unsigned char>& rgba, unsigned int& width, unsigned int& height, int factor) {
+  if (factor <= 1) {
+    return;
+  }
+  const unsigned int ds = (unsigned int)factor;
+  const unsigned int src_width = width;
+  width /= ds;
+  height /= ds;
+  std::vector<unsigned char> pixels(size_t(width) * size_t(height) * 4);
+  for (unsigned int y = 0; y < height; ++y) {
+    for (unsigned int x = 0; x < width; ++x) {
+      unsigned int sum[4] = { 0, 0, 0, 0 };
+      for (unsigned int by = 0; by < ds; ++by) {
+        const unsigned char* src = &rgba[((size_t(y) * ds + by) * src_width + size_t(x) * ds) * 4];
+        for (unsigned int bx = 0; bx < ds * 4; ++bx) {
+          sum[bx % 4] += src[bx];
+        }
+      }
+      unsigned char* dst = &pixels[(size_t(y) * width + x) * 4];
+      for (int c = 0; c < 4; ++c) {
+        dst[c] = (unsigned char)((sum[c] + ds * ds / 2) / (ds * ds));
+      }
+    }
+  }
+  rgba.swap(pixels);
+}
+
+std::vector<unsigned char> FrameCapture::EncodeQOI(const unsigned char* rgba, unsigned int width, unsigned int height) {
+  //https://qoiformat.org/qoi-specification.pdf
+  std::vector<unsigned char> out;
+  out.reserve(14 + size_t(width) * size_t(height) * 5 + 8);
+  const unsigned char header[4] = { 'q', 'o', 'i', 'f' };
+  out.insert(out.end(), header, header + 4);
+  for (int shift = 24; shift >= 0; shift -= 8) { out.push_back((unsigned char)(width >> shift)); }
+  for (int shift = 24; shift >= 0; shift -= 8) { out.push_back((unsigned char)(height >> shift)); }
+  out.push_back(4); //RGBA
+  out.push_back(0); //sRGB with linear alpha
+
+  unsigned char index[64][4];
+  std::memset(index, 0, sizeof(index));
+  unsigned char prev[4] = { 0, 0, 0, 255 };
+  int run = 0;
+  const size_t num_pixels = size_t(width) * size_t(height);
+  for (size_t i = 0; i < num_pixels; ++i) {
+    const unsigned char* px = &rgba[i * 4];
+    if (std::memcmp(px, prev, 4) == 0) {
+      run += 1;
+      if (run == 62 || i == num_pixels - 1) {
+        out.push_back((unsigned char)(0xC0 | (run - 1)));
+        run = 0;
+      }
+      continue;
+    }
+    if (run > 0) {
+      out.push_back((unsigned char)(0xC0 | (run - 1)));
+      run = 0;
+    }
+
+    const int hash = (px[0]*3 + px[1]*5 + px[2]*7 + px[3]*11) % 64;
+    if (std::memcmp(index[hash], px, 4) == 0) {
+      out.push_back((unsigned char)hash);
+    } else if (px[3] == prev[3]) {
+      const int dr = (signed char)(px[0] - prev[0]);
+      const int dg = (signed char)(px[1] - prev[1]);
+      const int db = (signed char)(px[2] - prev[2]);
+      const int dr_dg = dr - dg;
+      const int db_dg = db - dg;
+      if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+        out.push_back((unsigned char)(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+      } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+        out.push_back((unsigned char)(0x80 | (dg + 32)));
+        out.push_back((unsigned char)(((dr_dg + 8) << 4) | (db_dg + 8)));
+      } else {
+        out.push_back(0xFE);
+        out.insert(out.end(), px, px + 3);
+      }
+    } else {
+      out.push_back(0xFF);
+      out.insert(out.end(), px, px + 4);
+    }
+    std::memcpy(index[hash], px, 4);
+    std::memcpy(prev, px, 4);
+  }
+
+  const unsigned char end_marker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+  out.insert(out.end(), end_marker, end_marker + 8);
+  return out;
+}
@@ -0,0 +1,98 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Reads frames back a few frames late through pixel buffers and encodes them on worker threads
+class FrameCapture {
+public:
+  enum Format {
+    PNG,
+    QOI
+  };
+
+  FrameCapture();
+  ~FrameCapture();
+
+  //Needs an active context
+  void Init();
+
+  //Queues the target's current contents, call after drawing and before display
+  //Downsample averages square blocks of pixels for supersampled targets
+  void Capture(sf::RenderTarget& target, const std::string& fname, Format format, int downsample=1);
+  //Hands finished readbacks to the encoders, call once per frame
+  void Update();
+  //Queues an image that is already in memory, top row first
+  void Save(std::vector<unsigned char>& rgba, unsigned int width, unsigned int height, const std::string& fname, Format format);
+  //Finishes all readbacks and encodes
+  void Flush();
+
+  //Blocking capture waits for the GPU and encoders instead of dropping frames
+  void SetBlocking(bool b) { blocking = b; }
+  int GetDropped() const { return dropped; }
+
+  static std::vector<unsigned char> EncodeQOI(const unsigned char* rgba, unsigned int width, unsigned int height);
+  //Averages factor*factor blocks, partial blocks on the right and bottom are cropped
+  static void Downsample(std::vector<unsigned char>& rgba, unsigned int& width, unsigned int& height, int factor);
+
+private:
+  struct Job {
+    std::vector<unsigned char> pixels;
+    unsigned int width;
+    unsigned int height;
+    std::string fname;
+    Format format;
+    int downsample;
+    bool top_down;
+  };
+  struct Slot {
+    GLuint pbo;
+    bool pending;
+    int age;
+    Job job;
+  };
+
+  static const int num_slots = 3;
+
+  void StartWorkers();
+  void ReadSlot(Slot& slot);
+  void Push(Job& job);
+  void WorkerLoop();
+  static void Encode(Job& job);
+
+  bool use_pbo;
+  bool blocking;
+  Slot slots[num_slots];
+  int slot_ix;
+  int dropped;
+
+  std::vector<std::thread> workers;
+  std::deque<Job> jobs;
+  size_t max_jobs;
+  int busy;
+  bool quit;
+  std::mutex jobs_mutex;
+  std::condition_variable jobs_cv;
+  std::condition_variable done_cv;
+};
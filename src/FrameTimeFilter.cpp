@@ -0,0 +1,50 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "FrameTimeFilter.h"
+
+//Weight of the newest frame in the smoothed frame time
+static const float smooth_weight = 0.2f;
+//Frames to wait after a change before measuring again
+static const int settle_time = 8;
+
+FrameTimeFilter::FrameTimeFilter(float _target_ms, float _band_low, float _band_high) :
+  target_ms(_target_ms),
+  band_low(_band_low),
+  band_high(_band_high),
+  smooth_ms(0.0f),
+  settle_frames(settle_time) {
+}
+
+bool FrameTimeFilter::Update(float frame_ms) {
+  //Ignore frames rendered before the last change took effect
+  if (settle_frames > 0) {
+    settle_frames -= 1;
+    smooth_ms = frame_ms;
+    return false;
+  }
+  smooth_ms = smooth_ms*(1.0f - smooth_weight) + frame_ms*smooth_weight;
+  return true;
+}
+
+void FrameTimeFilter::Settle() {
+  settle_frames = settle_time;
+}
+
+void FrameTimeFilter::Reset() {
+  smooth_ms = 0.0f;
+  settle_frames = settle_time;
+}
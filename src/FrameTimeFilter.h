@@ -0,0 +1,45 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+//Smoothed frame time measured against a target for the controllers that
+//change what is rendered, so the frames from before a change are not counted
+class FrameTimeFilter {
+public:
+  FrameTimeFilter(float _target_ms, float _band_low, float _band_high);
+
+  //Feed the render time of the last frame, false while still settling
+  bool Update(float frame_ms);
+  //Call after every change so the old frames settle out
+  void Settle();
+  void Reset();
+
+  //Smoothed time over the target, over the band or under it
+  float GetRatio() const { return smooth_ms / target_ms; }
+  bool IsOver() const { return GetRatio() > band_high; }
+  bool IsUnder() const { return GetRatio() < band_low; }
+
+  float GetTarget() const { return target_ms; }
+  float GetSmoothTime() const { return smooth_ms; }
+
+private:
+  float target_ms;
+  float band_low;
+  float band_high;
+  float smooth_ms;
+  int settle_frames;
+};
@@ -0,0 +1,85 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GLExt.h"
+#include <cstdio>
+
+GLExt::GenQueriesFn GLExt::GenQueries = nullptr;
+GLExt::DeleteQueriesFn GLExt::DeleteQueries = nullptr;
+GLExt::BeginQueryFn GLExt::BeginQuery = nullptr;
+GLExt::EndQueryFn GLExt::EndQuery = nullptr;
+GLExt::GetQueryObjectivFn GLExt::GetQueryObjectiv = nullptr;
+GLExt::GetQueryObjectui64vFn GLExt::GetQueryObjectui64v = nullptr;
+GLExt::GenBuffersFn GLExt::GenBuffers = nullptr;
+GLExt::DeleteBuffersFn GLExt::DeleteBuffers = nullptr;
+GLExt::BindBufferFn GLExt::BindBuffer = nullptr;
+GLExt::BufferDataFn GLExt::BufferData = nullptr;
+GLExt::MapBufferFn GLExt::MapBuffer = nullptr;
+GLExt::UnmapBufferFn GLExt::UnmapBuffer = nullptr;
+bool GLExt::timer_query_ext = false;
+bool GLExt::pixel_buffer_ext = false;
+bool GLExt::float_texture_ext = false;
+
+static bool HasVersion(int need_major, int need_minor) {
+  //Starts with "major.minor" in every profile
+  const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  int major = 0;
+  int minor = 0;
+  if (!version || std::sscanf(version, "%d.%d", &major, &minor) != 2) {
+    return false;
+  }
+  return major > need_major || (major == need_major && minor >= need_minor);
+}
+
+void GLExt::Load() {
+  //Timer queries are core since OpenGL 3.3, otherwise need the extension
+  timer_query_ext = HasVersion(3, 3) || sf::Context::isExtensionAvailable("GL_ARB_timer_query") ||
+                    sf::Context::isExtensionAvailable("GL_EXT_timer_query");
+  GenQueries = (GenQueriesFn)sf::Context::getFunction("glGenQueries");
+  DeleteQueries = (DeleteQueriesFn)sf::Context::getFunction("glDeleteQueries");
+  BeginQuery = (BeginQueryFn)sf::Context::getFunction("glBeginQuery");
+  EndQuery = (EndQueryFn)sf::Context::getFunction("glEndQuery");
+  GetQueryObjectiv = (GetQueryObjectivFn)sf::Context::getFunction("glGetQueryObjectiv");
+  GetQueryObjectui64v = (GetQueryObjectui64vFn)sf::Context::getFunction("glGetQueryObjectui64v");
+  if (!GetQueryObjectui64v) {
+    GetQueryObjectui64v = (GetQueryObjectui64vFn)sf::Context::getFunction("glGetQueryObjectui64vEXT");
+  }
+
+  //Pixel buffers are core since OpenGL 2.1, otherwise need the extension
+  pixel_buffer_ext = HasVersion(2, 1) || sf::Context::isExtensionAvailable("GL_ARB_pixel_buffer_object");
+  GenBuffers = (GenBuffersFn)sf::Context::getFunction("glGenBuffers");
+  DeleteBuffers = (DeleteBuffersFn)sf::Context::getFunction("glDeleteBuffers");
+  BindBuffer = (BindBufferFn)sf::Context::getFunction("glBindBuffer");
+  BufferData = (BufferDataFn)sf::Context::getFunction("glBufferData");
+  MapBuffer = (MapBufferFn)sf::Context::getFunction("glMapBuffer");
+  UnmapBuffer = (UnmapBufferFn)sf::Context::getFunction("glUnmapBuffer");
+
+  //Float textures are core since OpenGL 3.0, otherwise need the extension
+  float_texture_ext = HasVersion(3, 0) || sf::Context::isExtensionAvailable("GL_ARB_texture_float");
+}
+
+bool GLExt::HasTimerQuery() {
+  return timer_query_ext && GenQueries && DeleteQueries && BeginQuery &&
+         EndQuery && GetQueryObjectiv && GetQueryObjectui64v;
+}
+
+bool GLExt::HasPixelBuffer() {
+  return pixel_buffer_ext && GenBuffers && DeleteBuffers && BindBuffer && BufferData && MapBuffer && UnmapBuffer;
+}
+
+bool GLExt::HasFloatTexture() {
+  return float_texture_ext;
+}
@@ -0,0 +1,74 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/OpenGL.hpp>
+#include <SFML/Window.hpp>
+#include <cstddef>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+//Not in the OpenGL 1.1 headers
+#define GL_TIME_ELAPSED 0x88BF
+#define GL_QUERY_RESULT 0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#define GL_STREAM_READ 0x88E1
+#define GL_READ_ONLY 0x88B8
+#define GL_RGBA32F 0x8814
+
+//OpenGL entry points past 1.1, loaded through the active SFML context
+class GLExt {
+public:
+  typedef void (APIENTRY *GenQueriesFn)(GLsizei n, GLuint* ids);
+  typedef void (APIENTRY *DeleteQueriesFn)(GLsizei n, const GLuint* ids);
+  typedef void (APIENTRY *BeginQueryFn)(GLenum target, GLuint id);
+  typedef void (APIENTRY *EndQueryFn)(GLenum target);
+  typedef void (APIENTRY *GetQueryObjectivFn)(GLuint id, GLenum pname, GLint* params);
+  typedef void (APIENTRY *GetQueryObjectui64vFn)(GLuint id, GLenum pname, sf::Uint64* params);
+  typedef void (APIENTRY *GenBuffersFn)(GLsizei n, GLuint* buffers);
+  typedef void (APIENTRY *DeleteBuffersFn)(GLsizei n, const GLuint* buffers);
+  typedef void (APIENTRY *BindBufferFn)(GLenum target, GLuint buffer);
+  typedef void (APIENTRY *BufferDataFn)(GLenum target, std::ptrdiff_t size, const void* data, GLenum usage);
+  typedef void* (APIENTRY *MapBufferFn)(GLenum target, GLenum access);
+  typedef GLboolean (APIENTRY *UnmapBufferFn)(GLenum target);
+
+  //Needs an active context, safe to call more than once
+  static void Load();
+  static bool HasTimerQuery();
+  static bool HasPixelBuffer();
+  static bool HasFloatTexture();
+
+  static GenQueriesFn GenQueries;
+  static DeleteQueriesFn DeleteQueries;
+  static BeginQueryFn BeginQuery;
+  static EndQueryFn EndQuery;
+  static GetQueryObjectivFn GetQueryObjectiv;
+  static GetQueryObjectui64vFn GetQueryObjectui64v;
+  static GenBuffersFn GenBuffers;
+  static DeleteBuffersFn DeleteBuffers;
+  static BindBufferFn BindBuffer;
+  static BufferDataFn BufferData;
+  static MapBufferFn MapBuffer;
+  static UnmapBufferFn UnmapBuffer;
+
+private:
+  static bool timer_query_ext;
+  static bool pixel_buffer_ext;
+  static bool float_texture_ext;
+};
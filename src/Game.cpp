@@ -2,6 +2,7 @@
 #include "Scene.h"
 #include "Scores.h"
 #include "Overlays.h"
+#include "FileUtil.h"
 
 #include <stdlib.h>
 
@@ -9,11 +10,25 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/OpenGL.hpp>
 
-Game::Game(){
+Game::Game() :
+	dyn_res(dyn_res_target_ms, dyn_res_min, dyn_res_max),
+	governor(governor_target_ms),
+	power_saver(power_idle_time) {
 	all_keys[sf::Keyboard::KeyCount] = {0};
 	mouse_clicked = false;
 	show_cheats = false;
 	show_cheats = false;
+	debug_dumps = 0;
+	take_screenshot = false;
+	screenshots = 0;
+	burst_on = false;
+	burst_runs = 0;
+	burst_frame = 0;
+	cpu_render = false;
+	dyn_res_on = false;
+	governor_on = false;
+	show_gpu_times = false;
+	measured_frame = -1;
 	GameMode game_mode = MAIN_MENU;
 
 	settings.majorVersion = 2;
@@ -24,6 +39,8 @@ Game::Game(){
 	LoadMusic();
 
 	GetDirectory();
+	thumbnails.Start(save_dir);
+	level_volume.Start(save_dir);
 	SetResolution();
 
 	CreateWindow();
@@ -32,8 +49,10 @@ Game::Game(){
 
 	scene = new Scene(&level1_music, &level2_music);
 	window_res = new sf::Glsl::Vec2((float)resolution->width, (float)resolution->height);
-	shader.setUniform("iResolution", window_res);
-	scene->Write(shader);
+	if (shader) {
+		shader->setUniform("iResolution", *window_res);
+		scene->Write(*shader);
+	}
 
 	//Create the menus
 	overlays = new Overlays(&font, &font_mono);
@@ -43,20 +62,13 @@ Game::Game(){
 }
 
 int Game::CheckEnvironment(){
-	//Make sure shader is supported
-	if (!sf::Shader::isAvailable()) {
-		ERROR_MSG("Graphics card does not support shaders");
-		exit(EXIT_FAILURE);
-	}
-	//Load the vertex shader
-	if (!shader.loadFromFile(vert_glsl, sf::Shader::Vertex)) {
-		ERROR_MSG("Failed to compile vertex shader");
-		exit(EXIT_FAILURE);
-	}
-	//Load the fragment shader
-	if (!shader.loadFromFile(frag_glsl, sf::Shader::Fragment)) {
-		ERROR_MSG("Failed to compile fragment shader");
-		exit(EXIT_FAILURE);
+	//Without shader support everything is drawn by the software renderer
+	shader = nullptr;
+	cpu_render = !sf::Shader::isAvailable();
+	if (cpu_render) {
+		std::cerr << "Graphics card does not support shaders, using the software renderer" << std::endl;
+	} else {
+		LoadShaders();
 	}
 
 	//Load the font
@@ -72,6 +84,28 @@ int Game::CheckEnvironment(){
 	return 0;
 }
 
+int Game::LoadShaders(){
+	//Load the shader sources and quality presets
+	if (!shader_variants.Load(vert_glsl, frag_glsl, presets_txt)) {
+		ERROR_MSG("Unable to load shaders");
+		exit(EXIT_FAILURE);
+	}
+	//Compile the default quality variant
+	quality = std::max(shader_variants.Find(default_quality), 0);
+	shader = shader_variants.Get(quality);
+	if (!shader) {
+		ERROR_MSG("Failed to compile fragment shader");
+		exit(EXIT_FAILURE);
+	}
+	ResetMarchDetail();
+	//Load the upscaling shader
+	if (!upscale_shader.loadFromFile(vert_glsl, upscale_glsl)) {
+		ERROR_MSG("Failed to compile upscale shader");
+		exit(EXIT_FAILURE);
+	}
+	return 0;
+}
+
 void Game::LoadMusic(){
 	//Load the music
 	menu_music.openFromFile(menu_ogg);
@@ -92,16 +126,10 @@ int Game::GetDirectory(){
 	  save_dir = std::string(std::getenv("HOME")) + "/.MarbleMarcher";
 	#endif
 	  
-	  if (!dirExists(save_dir.c_str())) {
-	#if defined(_WIN32)
-	    success = CreateDirectory(save_dir.c_str(), NULL) != 0 || GetLastError() == ERROR_ALREADY_EXISTS;
-	#else
-	    success = mkdir(save_dir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0;
-	#endif
-	    if (!success) {
-	      ERROR_MSG("Failed to create save directory");
-	      return 1;
-	    }
+	  success = FileUtil::CreateDir(save_dir);
+	  if (!success) {
+	    ERROR_MSG("Failed to create save directory");
+	    return 1;
 	  }
 	  save_file = save_dir + "/scores.bin";
 
@@ -136,6 +164,10 @@ void Game::CreateWindow(){
 	window->setVerticalSyncEnabled(true);
 	window->setKeyRepeatEnabled(false);
 	window->requestFocus();
+
+	//Timer queries and pixel buffers need a context
+	gpu_timer.Init();
+	frame_capture.Init();
 }
 
 void Game::CreateRenderTexture(){
@@ -156,8 +188,10 @@ void Game::CreateRenderTexture(){
 void Game::CreateFractalScene(){
 	scene = new Scene(&level1_music, &level2_music);
 	window_res = new sf::Glsl::Vec2((float)resolution->width, (float)resolution->height);
-	shader.setUniform("iResolution", window_res);
-	scene->Write(shader);
+	if (shader) {
+		shader->setUniform("iResolution", *window_res);
+		scene->Write(*shader);
+	}
 }
 
 void Game::CreateMenus(){
@@ -171,12 +205,24 @@ void Game::CreateMenus(){
 void Game::GameLoop(){
 	//Main loop
   sf::Clock clock;
+  sf::Clock power_clock;
+  sf::Clock gpu_log_clock;
   float smooth_fps = 60.0f;
+  float frame_ms = 0.0f;
   int lag_ms = 0;
   while (window->isOpen()) {
     sf::Event event;
     float mouse_wheel = 0.0f;
+    bool had_input = false;
     while (window->pollEvent(event)) {
+      if (event.type == sf::Event::KeyPressed || event.type == sf::Event::MouseButtonPressed ||
+          event.type == sf::Event::MouseWheelScrolled) {
+        had_input = true;
+      } else if (event.type == sf::Event::MouseMoved) {
+        //Re-centering the locked mouse moves it back to where it was
+        had_input = had_input || (mouse_pos != sf::Vector2i(event.mouseMove.x, event.mouseMove.y));
+      }
+
       if (event.type == sf::Event::Closed) {
         window->close();
         break;
@@ -216,6 +262,46 @@ void Game::GameLoop(){
           if (game_mode == PLAYING) {
             scene->ResetLevel();
           }
+        } else if (keycode == sf::Keyboard::E) {
+          //Fly off to explore the fractal and come back to the waiting marble
+          if (game_mode == PLAYING && scene->GetMode() == Camera::MARBLE) {
+            scene->SetMode(Camera::EXPLORE);
+          } else if (game_mode == PLAYING && scene->GetMode() == Camera::EXPLORE) {
+            scene->SetMode(Camera::MARBLE);
+          }
+        } else if (keycode == sf::Keyboard::F1) {
+          marble_probe.SetEnabled(!marble_probe.IsEnabled());
+          std::cout << "Marble reflections " << (marble_probe.IsEnabled() ? "from the probe" : "traced") << std::endl;
+        } else if (keycode == sf::Keyboard::F2 && shader) {
+          ReportMarchSteps();
+        } else if (keycode == sf::Keyboard::F3) {
+          const int mode = (renderer.GetDebugMode() + 1) % Renderer::NUM_DEBUG_MODES;
+          renderer.SetDebugMode(Renderer::DebugMode(mode));
+        } else if (keycode == sf::Keyboard::F4 && shader) {
+          DumpDebugFrame();
+        } else if (keycode == sf::Keyboard::F5 && shader) {
+          cpu_render = !cpu_render;
+          std::cout << (cpu_render ? "Software" : "GPU") << " rendering" << std::endl;
+        } else if (keycode == sf::Keyboard::F6) {
+          renderer.SetAdaptiveAA(!renderer.IsAdaptiveAA());
+        } else if (keycode == sf::Keyboard::F7 && event.key.shift) {
+          ToggleGovernor();
+        } else if (keycode == sf::Keyboard::F7) {
+          ToggleDynamicRes();
+        } else if (keycode == sf::Keyboard::F8) {
+          renderer.SetTemporal(!renderer.IsTemporal());
+        } else if (keycode == sf::Keyboard::F9 && shader) {
+          SetQuality((quality + 1) % shader_variants.NumPresets());
+        } else if (keycode == sf::Keyboard::F10) {
+          show_gpu_times = !show_gpu_times;
+          UpdateGpuTimer();
+          if (!gpu_timer.IsSupported()) {
+            std::cerr << "GPU timer queries are not supported" << std::endl;
+          }
+        } else if (keycode == sf::Keyboard::F11) {
+          take_screenshot = true;
+        } else if (keycode == sf::Keyboard::F12) {
+          ToggleBurst();
         }
         all_keys[keycode] = true;
       } else if (event.type == sf::Event::KeyReleased) {
@@ -238,6 +324,7 @@ void Game::GameLoop(){
               game_mode = CONTROLS;
             } else if (selected == Overlays::LEVELS) {
               game_mode = LEVELS;
+              thumbnails.Request();
               scene->SetExposure(0.5f);
             } else if (selected == Overlays::SCREEN_SAVER) {
               game_mode = SCREEN_SAVER;
@@ -316,6 +403,13 @@ void Game::GameLoop(){
       }
     }
 
+    //Drop resolution and frame rate while idle or in the background
+    const PowerSaver::State power_state = power_saver.GetState();
+    power_saver.Update(power_clock.restart().asSeconds(), window->hasFocus(), had_input);
+    if (power_saver.GetState() != power_state && power_saver.GetScale() < 1.0f) {
+      CreateScaledTexture();
+    }
+
     //Check if the game was beat
     if (scene->GetMode() == Camera::FINAL && game_mode != CREDITS) {
       game_mode = CREDITS;
@@ -333,6 +427,7 @@ void Game::GameLoop(){
       overlays->UpdateControls((float)mouse_pos.x, (float)mouse_pos.y);
     } else if (game_mode == LEVELS) {
       scene->UpdateCamera();
+      thumbnails.Update();
       overlays->UpdateLevels((float)mouse_pos.x, (float)mouse_pos.y);
     } else if (game_mode == SCREEN_SAVER) {
       scene->UpdateCamera();
@@ -358,9 +453,13 @@ void Game::GameLoop(){
       const float cam_ud = float(-mouse_delta.y) * ms;
       const float cam_z = mouse_wheel * wheel_sensitivity;
 
-      //Apply forces to marble and camera
-      scene->UpdateMarble(force_lr, force_ud);
-      scene->UpdateCamera(cam_lr, cam_ud, cam_z);
+      //Apply forces to marble and camera, or fly the camera while exploring
+      if (scene->GetMode() == Camera::EXPLORE) {
+        scene->UpdateExplore(cam_lr, cam_ud, cam_z, force_lr, force_ud);
+      } else {
+        scene->UpdateMarble(force_lr, force_ud);
+        scene->UpdateCamera(cam_lr, cam_ud, cam_z);
+      }
     } else if (game_mode == PAUSED) {
       overlays->UpdatePaused((float)mouse_pos.x, (float)mouse_pos.y);
     }
@@ -370,41 +469,62 @@ void Game::GameLoop(){
       //If there is too much lag, just do another frame of physics and skip the draw
       lag_ms -= 16;
       skip_frame = true;
+    } else if (cpu_render) {
+      //Ray march on the CPU and stretch the image over the window
+      DrawSoftware();
     } else {
-      //Update the shader values
-      scene->Write(shader);
+      //Shadows and distances are baked once the level's fractal settles, and marched until then
+      const bool is_static = scene->IsFractalStatic();
+      if (is_static) {
+        level_volume.Request(scene->GetLevel());
+      }
+      level_volume.Update();
+      //Exploring zooms in far below a texel, where only marched shadows and steps hold up
+      level_volume.Write(*shader, scene->GetLevel(), is_static && scene->GetMode() != Camera::EXPLORE);
 
-      //Setup full-screen shader
-      sf::RenderStates states = sf::RenderStates::Default;
-      states.shader = &shader;
-      sf::RectangleShape rect;
-      rect.setSize(*window_res);
-      rect.setPosition(0, 0);
+      //Update the shader values
+      scene->SetMarchLimits(governor.GetMaxMarches(), governor.GetMinDist(), governor.GetShadowSharpness());
+      scene->Write(*shader);
+      marble_probe.Update(*shader, renderer, *scene);
+      marble_probe.Write(*shader);
+      std::vector<float> view_state = scene->GetViewState();
+      view_state.push_back(float(marble_probe.GetVersion()));
+      renderer.SetViewState(view_state);
 
       //Draw the fractal
-      if (fullscreen) {
-        //Draw to the render texture
-        renderTexture.draw(rect, states);
+      const float power_scale = power_saver.GetScale();
+      sf::Clock render_clock;
+      if (fullscreen || dyn_res_on || power_scale < 1.0f) {
+        //Draw to the render texture at the current scale
+        const float scale = std::min(dyn_res.GetScale(), power_scale);
+        const sf::Vector2f size(std::floor(window_res->x * scale), std::floor(window_res->y * scale));
+        gpu_timer.Begin(GpuTimer::FRACTAL, renderTexture);
+        renderer.Draw(renderTexture, *shader, size);
+        gpu_timer.End(GpuTimer::FRACTAL, renderTexture, !renderer.IsFrameCached());
+        MeasureFrame(render_clock);
         renderTexture.display();
 
-        //Draw render texture to main window
-        sf::Sprite sprite(renderTexture.getTexture());
-        sprite.setScale(float(screen_size.width) / float(resolution->width),
-                        float(screen_size.height) / float(resolution->height));
-        window->draw(sprite);
+        //Upscale the rendered corner of the render texture to the main window
+        gpu_timer.Begin(GpuTimer::UPSCALE, *window);
+        renderer.Upscale(*window, upscale_shader, renderTexture.getTexture(), size);
+        gpu_timer.End(GpuTimer::UPSCALE, *window);
       } else {
         //Draw directly to the main window
-        window->draw(rect, states);
+        gpu_timer.Begin(GpuTimer::FRACTAL, *window);
+        renderer.Draw(*window, *shader, *window_res);
+        gpu_timer.End(GpuTimer::FRACTAL, *window, !renderer.IsFrameCached());
+        MeasureFrame(render_clock);
       }
     }
 
     //Draw text overlays to the window
+    gpu_timer.Begin(GpuTimer::OVERLAYS, *window);
     if (game_mode == MAIN_MENU) {
       overlays->DrawMenu(*window);
     } else if (game_mode == CONTROLS) {
       overlays->DrawControls(*window);
     } else if (game_mode == LEVELS) {
-      overlays->DrawLevels(*window);
+      overlays->DrawLevels(*window, thumbnails);
     } else if (game_mode == PLAYING) {
       if (scene->GetMode() == Camera::ORBIT && scene->GetMarble().GetPosition().x() < 998.0f) {
         overlays->DrawLevelDesc(*window, scene->GetLevel());
@@ -418,13 +538,42 @@ void Game::GameLoop(){
       overlays->DrawCredits(*window);
     }
     overlays->DrawFPS(*window, int(smooth_fps + 0.5f));
+    if (renderer.GetDebugMode() != Renderer::DEBUG_OFF) {
+      overlays->DrawDebugLegend(*window, renderer.GetDebugMode());
+    }
+    if (show_gpu_times && gpu_timer.IsEnabled()) {
+      overlays->DrawGpuTimes(*window, gpu_timer, frame_ms);
+    }
+    gpu_timer.End(GpuTimer::OVERLAYS, *window);
 
     if (!skip_frame) {
+      //Read back before the swap, the encode happens a few frames later
+      if (take_screenshot) {
+        const std::string fname = save_dir + "/screenshot_" + std::to_string(screenshots++) + ".png";
+        frame_capture.Capture(*window, fname, FrameCapture::PNG);
+        std::cout << "Saving screenshot to " << fname << std::endl;
+        take_screenshot = false;
+      }
+      if (burst_on) {
+        const std::string fname = save_dir + "/burst_" + std::to_string(burst_runs) + "_" + std::to_string(burst_frame++) + ".qoi";
+        frame_capture.Capture(*window, fname, FrameCapture::QOI);
+        if (burst_frame >= burst_max_frames) {
+          ToggleBurst();
+        }
+      }
+      frame_capture.Update();
+
       //Finally display to the screen
       window->display();
+      power_saver.AddFrame();
 
       //If V-Sync is running higher than desired fps, slow down!
       const float s = clock.restart().asSeconds();
+      frame_ms = s * 1000.0f;
+      if (show_gpu_times && gpu_timer.IsEnabled() && gpu_log_clock.getElapsedTime().asSeconds() >= gpu_log_period) {
+        std::cout << gpu_timer.Report() << ", frame " << frame_ms << std::endl;
+        gpu_log_clock.restart();
+      }
       if (s > 0.0f) {
         smooth_fps = smooth_fps*0.9f + std::min(1.0f / s, 60.0f)*0.1f;
       }
@@ -435,8 +584,19 @@ void Game::GameLoop(){
       } else if (time_diff_ms < 0) {
         lag_ms += std::max(-time_diff_ms, 0);
       }
+
+      //Lower frame rates just wait longer, physics catches up through the lag
+      const int power_wait_ms = int(1000.0f / power_saver.GetFPS() - 16.66667f);
+      if (power_wait_ms > 0) {
+        sf::sleep(sf::milliseconds(power_wait_ms));
+      }
     }
   }
+  std::cout << power_saver.Report() << std::endl;
+  if (burst_on) {
+    ToggleBurst();
+  }
+  frame_capture.Flush();
 
   //Stop all music
   menu_music.stop();
@@ -447,6 +607,163 @@ void Game::GameLoop(){
 }
 
 
+void Game::ReportMarchSteps() {
+  //Render the current view with and without over-relaxation
+  const float omegas[2] = { 1.0f, all_levels[scene->GetLevel()].march_omega };
+  double avg_steps[2];
+  scene->Write(*shader);
+  for (int i = 0; i < 2; ++i) {
+    shader->setUniform("iMarchOmega", omegas[i]);
+    const std::vector<unsigned short> counts = renderer.ReadDebug(*shader, *window_res, Renderer::DEBUG_DE_CALLS);
+    double total = 0.0;
+    for (size_t j = 0; j < counts.size(); ++j) {
+      total += counts[j];
+    }
+    avg_steps[i] = total / double(std::max(counts.size(), size_t(1)));
+  }
+  scene->InvalidateUniforms();
+  scene->Write(*shader);
+
+  std::cout << "Level " << (scene->GetLevel() + 1) << ": " <<
+    avg_steps[0] << " DE calls/pixel at omega 1.0, " <<
+    avg_steps[1] << " at omega " << omegas[1] << std::endl;
+}
+
+void Game::ToggleBurst() {
+  burst_on = !burst_on;
+  if (burst_on) {
+    burst_frame = 0;
+    std::cout << "Recording burst " << burst_runs << std::endl;
+  } else {
+    std::cout << "Burst " << burst_runs << " finished, " << burst_frame << " frames, " <<
+      frame_capture.GetDropped() << " dropped in total" << std::endl;
+    burst_runs += 1;
+  }
+}
+
+void Game::DrawSoftware() {
+  //Keep the aspect ratio of the window at a fixed width
+  const unsigned int width = cpu_render_width;
+  const unsigned int height = std::max(1u, (unsigned int)(width * window_res->y / window_res->x));
+  if (!cpu_renderer) {
+    cpu_renderer.reset(new CpuRenderer());
+  }
+  cpu_renderer->Render(*scene, width, height, cpu_pixels);
+
+  if (cpu_texture.getSize() != sf::Vector2u(width, height)) {
+    cpu_texture.create(width, height);
+    cpu_texture.setSmooth(true);
+  }
+  cpu_texture.update(cpu_pixels.data());
+
+  sf::Sprite sprite(cpu_texture);
+  sprite.setScale(window_res->x / width, window_res->y / height);
+  window->setView(window->getDefaultView());
+  window->draw(sprite);
+}
+
+void Game::SetQuality(int preset) {
+  //Variants are compiled once and kept
+  sf::Shader* variant = shader_variants.Get(preset);
+  if (!variant) {
+    std::cerr << "Failed to compile quality preset " << shader_variants.GetName(preset) << std::endl;
+    return;
+  }
+  quality = preset;
+  shader = variant;
+  ResetMarchDetail();
+  scene->SetMarchLimits(governor.GetMaxMarches(), governor.GetMinDist(), governor.GetShadowSharpness());
+  scene->Write(*shader);
+  std::cout << "Quality: " << shader_variants.GetName(quality) << std::endl;
+}
+
+void Game::ToggleDynamicRes() {
+  dyn_res_on = !dyn_res_on;
+  dyn_res.Reset(dyn_res_max);
+  if (dyn_res_on) {
+    CreateScaledTexture();
+  }
+  if (dyn_res_on && governor_on) {
+    ToggleGovernor();
+  }
+  UpdateGpuTimer();
+}
+
+void Game::ToggleGovernor() {
+  //Both answer to the same frame time, so only one of them adapts at once
+  governor_on = !governor_on;
+  governor.Reset();
+  if (governor_on && dyn_res_on) {
+    ToggleDynamicRes();
+  }
+  UpdateGpuTimer();
+  std::cout << "Quality governor " << (governor_on ? "on" : "off") << std::endl;
+}
+
+void Game::ResetMarchDetail() {
+  //The preset's own values are the governor's full detail
+  governor.SetFullDetail(shader_variants.GetValue(quality, "MAX_MARCHES", 1000.0f),
+                         shader_variants.GetValue(quality, "MIN_DIST", 1e-5f),
+                         shader_variants.GetValue(quality, "SHADOW_SHARPNESS", 10.0f));
+  governor.Reset();
+}
+
+void Game::MeasureFrame(const sf::Clock& render_clock) {
+  //Cached frames skip the fractal shader, their near zero time is not headroom
+  if ((!dyn_res_on && !governor_on) || renderer.IsFrameCached()) {
+    return;
+  }
+  float frame_ms = 0.0f;
+  if (gpu_timer.IsSupported()) {
+    //The fractal pass from the timer queries, which never stall the pipeline, each result used once
+    const int frame = gpu_timer.GetLastFrame(GpuTimer::FRACTAL);
+    if (frame < 0 || frame == measured_frame) {
+      return;
+    }
+    measured_frame = frame;
+    frame_ms = gpu_timer.GetLastMs(GpuTimer::FRACTAL);
+  } else {
+    //Without queries, wait for the GPU so the measured time is the real render cost
+    glFinish();
+    frame_ms = render_clock.getElapsedTime().asSeconds() * 1000.0f;
+  }
+  if (dyn_res_on) {
+    dyn_res.Update(frame_ms);
+  } else {
+    governor.Update(frame_ms);
+  }
+}
+
+void Game::UpdateGpuTimer() {
+  //The overlay and both controllers read from the timer queries
+  gpu_timer.SetEnabled(show_gpu_times || dyn_res_on || governor_on);
+}
+
+void Game::CreateScaledTexture() {
+  //Windowed mode draws directly to the window, so it may not have a render texture yet
+  if (renderTexture.getSize().x == 0) {
+    renderTexture.create(resolution->width, resolution->height, settings);
+    renderTexture.setSmooth(true);
+  }
+}
+
+void Game::DumpDebugFrame() {
+  //Store the camera so the exact view can be found again
+  std::string comment = "Level " + std::to_string(scene->GetLevel() + 1) + " camera";
+  const Eigen::Matrix4f cam_mat = scene->GetCamera().GetMatrix();
+  for (int i = 0; i < 16; ++i) {
+    comment += " " + std::to_string(cam_mat.data()[i]);
+  }
+
+  const std::string fname = save_dir + "/debug_" + std::to_string(debug_dumps++) + ".pgm";
+  scene->Write(*shader);
+  if (renderer.DumpDebug(*shader, *window_res, fname, comment)) {
+    std::cout << "Saved debug frame to " << fname << std::endl;
+  } else {
+    std::cerr << "Failed to save " << fname << std::endl;
+  }
+}
+
 float Game::GetVol() {
   if (!music_on) {
     return 0.0f;
@@ -468,12 +785,3 @@ void Game::LockMouse(sf::RenderWindow& window) {
 void Game::UnlockMouse(sf::RenderWindow& window) {
   window.setMouseCursorVisible(true);
 }
-int Game::dirExists(const char *path) {
-  struct stat info;
-  if (stat(path, &info) != 0) {
-    return 0;
-  } else if (info.st_mode & S_IFDIR) {
-    return 1;
-  }
-  return 0;
-}
@@ -4,6 +4,17 @@
 #include "SelectRes.h"
 #include "Scores.h"
 #include "Level.h"
+#include "Renderer.h"
+#include "DynamicRes.h"
+#include "QualityGovernor.h"
+#include "ShaderVariants.h"
+#include "PowerSaver.h"
+#include "GpuTimer.h"
+#include "FrameCapture.h"
+#include "CpuRenderer.h"
+#include "ThumbnailCache.h"
+#include "LevelVolume.h"
+#include "MarbleProbe.h"
 
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
@@ -17,6 +28,7 @@
 #include <fstream>
 #include <thread>
 #include <mutex>
+#include <memory>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -29,6 +41,15 @@ static const float mouse_sensitivity = 0.005f;
 static const float wheel_sensitivity = 0.2f;
 static const float music_vol = 75.0f;
 static const float target_fps = 60.0f;
+static const float dyn_res_target_ms = 14.0f; //Leaves room for overlays and the swap
+static const float dyn_res_min = 0.5f;
+static const float dyn_res_max = 1.0f;
+static const float governor_target_ms = 14.0f;
+static const char default_quality[] = "high";
+static const float power_idle_time = 120.0f; //Seconds without input before saving power
+static const float gpu_log_period = 5.0f;
+static const int burst_max_frames = 600; //10 seconds at 60fps
+static const int cpu_render_width = 320;
 
 class Game {
 public:
@@ -47,9 +68,9 @@ public:
 
 	float GetVol();
 	int CheckEnvironment();
+	int LoadShaders();
 	void LockMouse(sf::RenderWindow& window);
 	void UnlockMouse(sf::RenderWindow& window);
-	int dirExists(const char *path);
 
 	void LoadMusic();
 	int GetDirectory();
@@ -59,8 +80,22 @@ public:
 	void CreateFractalScene();
 	void CreateMenus();
 	void GameLoop();
+	void ReportMarchSteps();
+	void DumpDebugFrame();
+	void ToggleDynamicRes();
+	void ToggleGovernor();
+	void ResetMarchDetail();
+	void MeasureFrame(const sf::Clock& render_clock);
+	void UpdateGpuTimer();
+	void CreateScaledTexture();
+	void SetQuality(int preset);
+	void ToggleBurst();
+	void DrawSoftware();
 private:
-	sf::Shader shader;
+	ShaderVariants shader_variants;
+	sf::Shader* shader;
+	int quality;
+	sf::Shader upscale_shader;
 	sf::Font font;
 	sf::Font font_mono;
 
@@ -90,6 +125,30 @@ private:
 	sf::Vector2i* screen_center;
 
 	sf::RenderTexture renderTexture;
+	Renderer renderer;
+	DynamicRes dyn_res;
+	bool dyn_res_on;
+	QualityGovernor governor;
+	bool governor_on;
+	PowerSaver power_saver;
+	GpuTimer gpu_timer;
+	int measured_frame;
+	bool show_gpu_times;
+	int debug_dumps;
+	FrameCapture frame_capture;
+	bool take_screenshot;
+	int screenshots;
+	bool burst_on;
+	int burst_runs;
+	int burst_frame;
+	//Made on the first software frame so its threads only run for those who use it
+	std::unique_ptr<CpuRenderer> cpu_renderer;
+	bool cpu_render;
+	sf::Texture cpu_texture;
+	std::vector<unsigned char> cpu_pixels;
+	ThumbnailCache thumbnails;
+	LevelVolume level_volume;
+	MarbleProbe marble_probe;
 	
 	Scene* scene;
 	sf::Glsl::Vec2* window_res;
@@ -0,0 +1,131 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GpuTimer.h"
+#include "GLExt.h"
+#include <sstream>
+
+//Weight of the newest result in the rolling average
+static const float smooth_weight = 0.1f;
+
+GpuTimer::GpuTimer() :
+  supported(false),
+  active(false) {
+  for (int i = 0; i < NUM_PASSES; ++i) {
+    context_id[i] = 0;
+    frame_ix[i] = 0;
+    frame_count[i] = 0;
+    last_frame[i] = -1;
+    smooth_ms[i] = 0.0f;
+    last_ms[i] = 0.0f;
+    for (int j = 0; j < num_frames; ++j) {
+      queries[i][j] = 0;
+      pending[i][j] = false;
+      keep[i][j] = false;
+      slot_frame[i][j] = 0;
+    }
+  }
+}
+
+bool GpuTimer::Init() {
+  GLExt::Load();
+  supported = GLExt::HasTimerQuery();
+  return supported;
+}
+
+void GpuTimer::Begin(Pass pass, sf::RenderTarget& target) {
+  if (!active) {
+    return;
+  }
+  target.setActive(true);
+
+  //Queries belong to the context they were made in
+  const sf::Uint64 cur_context = sf::Context::getActiveContextId();
+  if (context_id[pass] != cur_context) {
+    if (context_id[pass] != 0) {
+      GLExt::DeleteQueries(num_frames, queries[pass]);
+    }
+    GLExt::GenQueries(num_frames, queries[pass]);
+    context_id[pass] = cur_context;
+    for (int i = 0; i < num_frames; ++i) {
+      pending[pass][i] = false;
+    }
+  }
+
+  //Collect old results first, a query still in flight is skipped rather than waited on
+  Collect(pass);
+  const int ix = frame_ix[pass];
+  if (!pending[pass][ix]) {
+    GLExt::BeginQuery(GL_TIME_ELAPSED, queries[pass][ix]);
+  }
+}
+
+void GpuTimer::End(Pass pass, sf::RenderTarget& target, bool keep_last) {
+  if (!active || context_id[pass] == 0) {
+    return;
+  }
+  target.setActive(true);
+  const int ix = frame_ix[pass];
+  if (!pending[pass][ix] && sf::Context::getActiveContextId() == context_id[pass]) {
+    GLExt::EndQuery(GL_TIME_ELAPSED);
+    pending[pass][ix] = true;
+    keep[pass][ix] = keep_last;
+    slot_frame[pass][ix] = frame_count[pass]++;
+    frame_ix[pass] = (ix + 1) % num_frames;
+  }
+}
+
+void GpuTimer::Collect(Pass pass) {
+  //Oldest slot first, so the rolling average sees frames in order
+  for (int k = 0; k < num_frames; ++k) {
+    const int i = (frame_ix[pass] + k) % num_frames;
+    if (!pending[pass][i]) {
+      continue;
+    }
+    GLint available = 0;
+    GLExt::GetQueryObjectiv(queries[pass][i], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      continue;
+    }
+    sf::Uint64 ns = 0;
+    GLExt::GetQueryObjectui64v(queries[pass][i], GL_QUERY_RESULT, &ns);
+    const float ms = float(double(ns) * 1e-6);
+    if (keep[pass][i] && slot_frame[pass][i] > last_frame[pass]) {
+      last_ms[pass] = ms;
+      last_frame[pass] = slot_frame[pass][i];
+    }
+    smooth_ms[pass] = (smooth_ms[pass] == 0.0f ? ms : smooth_ms[pass]*(1.0f - smooth_weight) + ms*smooth_weight);
+    pending[pass][i] = false;
+  }
+}
+
+const char* GpuTimer::PassName(Pass pass) {
+  switch (pass) {
+  case FRACTAL: return "fractal";
+  case UPSCALE: return "upscale";
+  default: return "overlays";
+  }
+}
+
+std::string GpuTimer::Report() const {
+  std::ostringstream report;
+  report.precision(3);
+  report << "GPU ms:";
+  for (int i = 0; i < NUM_PASSES; ++i) {
+    report << (i > 0 ? "," : "") << " " << PassName(Pass(i)) << " " << smooth_ms[i];
+  }
+  return report.str();
+}
@@ -0,0 +1,71 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <string>
+
+//Rolling GPU time per render pass from asynchronous timer queries
+class GpuTimer {
+public:
+  enum Pass {
+    FRACTAL,
+    UPSCALE,
+    OVERLAYS,
+    NUM_PASSES
+  };
+
+  GpuTimer();
+
+  //Loads the query functions, false if timer queries are not supported
+  bool Init();
+  bool IsSupported() const { return supported; }
+
+  void SetEnabled(bool enabled) { active = enabled && supported; }
+  bool IsEnabled() const { return active; }
+
+  //Brackets the GL commands of a pass drawn to the target, results ended with
+  //keep_last false only go into the rolling average and never into GetLastMs
+  void Begin(Pass pass, sf::RenderTarget& target);
+  void End(Pass pass, sf::RenderTarget& target, bool keep_last=true);
+
+  float GetMs(Pass pass) const { return smooth_ms[pass]; }
+  //Newest single result, a few frames old since queries are never waited on, 0 before the first
+  float GetLastMs(Pass pass) const { return last_ms[pass]; }
+  //Count of the frame GetLastMs came from, -1 before the first
+  int GetLastFrame(Pass pass) const { return last_frame[pass]; }
+  static const char* PassName(Pass pass);
+  std::string Report() const;
+
+private:
+  static const int num_frames = 4;
+
+  void Collect(Pass pass);
+
+  bool supported;
+  bool active;
+  GLuint queries[NUM_PASSES][num_frames];
+  bool pending[NUM_PASSES][num_frames];
+  bool keep[NUM_PASSES][num_frames];
+  int slot_frame[NUM_PASSES][num_frames];
+  int frame_count[NUM_PASSES];
+  int last_frame[NUM_PASSES];
+  sf::Uint64 context_id[NUM_PASSES];
+  int frame_ix[NUM_PASSES];
+  float smooth_ms[NUM_PASSES];
+  float last_ms[NUM_PASSES];
+};
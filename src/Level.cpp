@@ -29,7 +29,9 @@ const Level all_levels[num_levels] = {
     Eigen::Vector3f(2.95227f, 2.65057f, 1.11848f),   //Flag Position
     -4.0f,                                           //Death Barrier
     false,                                           //Is Planet
-    "Jump The Crater"),                              //Description
+    "Jump The Crater",                               //Description
+    0.0f, 0.0f, 0.0f,                                //Animation
+    1.4f),                                           //March Relaxation
 
   //Level 2   
   Level(
@@ -57,7 +59,9 @@ const Level all_levels[num_levels] = {
     Eigen::Vector3f(0.0f, -6.25f, 0.0f),             //Flag Position
     -7.0f,                                           //Death Barrier
     false,                                           //Is Planet
-    "Hole In One"),                                  //Description
+    "Hole In One",                                   //Description
+    0.0f, 0.0f, 0.0f,                                //Animation
+    1.4f),                                           //March Relaxation
 
   //Level 4
   Level(
@@ -244,7 +248,8 @@ Level::Level(float s, float a1, float a2,
   float kill,
   bool pg,
   const char* desc,
-  float an1, float an2, float an3)
+  float an1, float an2, float an3,
+  float omega)
 {
   params[0] = s;
   params[1] = a1;
@@ -262,4 +267,5 @@ Level::Level(float s, float a1, float a2,
   anim_1 = an1;
   anim_2 = an2;
   anim_3 = an3;
+  march_omega = omega;
 }
@@ -19,6 +19,7 @@
 
 static const int num_levels = 15;
 static const int num_fractal_params = 9;
+static const float default_march_omega = 1.2f;
 typedef Eigen::Matrix<float, num_fractal_params, 1> FractalParams;
 
 class Level {
@@ -34,7 +35,10 @@ public:
         float kill,
         bool planet,
         const char* desc,
-        float an1=0.0f, float an2=0.0f, float an3=0.0f);
+        float an1=0.0f, float an2=0.0f, float an3=0.0f,
+        float omega=default_march_omega);
+
+  bool IsAnimated() const { return anim_1 != 0.0f || anim_2 != 0.0f || anim_3 != 0.0f; }
 
   FractalParams params;      //Fractal parameters
   float marble_rad;          //Radius of the marble
@@ -48,6 +52,7 @@ public:
   float anim_1;              //Animation amount for angle1 parameter
   float anim_2;              //Animation amount for angle2 parameter
   float anim_3;              //Animation amount for offset_y parameter
+  float march_omega;         //Over-relaxation factor for ray marching
 };
 
 extern const Level all_levels[num_levels];
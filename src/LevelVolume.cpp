@@ -0,0 +1,231 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "LevelVolume.h"
+#include "CpuRenderer.h"
+#include "FileUtil.h"
+#include "FragDefines.h"
+#include "Scene.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+typedef Scene::Packet Packet;
+
+//Texels per side and slices per row of the atlas, 2048x1024 in total
+static const int volume_res = 128;
+static const int atlas_cols = 16;
+//Bump when the bake changes so old volumes are replaced
+static const sf::Uint32 volume_version = 3;
+
+//Calls bake with 8 texel centers at a time and stores its results in [0, 255],
+//slices are interleaved between the threads so they finish together
+template<typename F>
+static std::vector<unsigned char> BakeTexels(int res, float bound, int num_threads, F bake) {
+  std::vector<unsigned char> volume(size_t(res) * size_t(res) * size_t(res));
+  const float texel = 2.0f * bound / float(res);
+  const int step_z = std::max(num_threads, 1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < step_z; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int z = t; z < res; z += step_z) {
+        for (int y = 0; y < res; ++y) {
+          for (int x = 0; x < res; x += 8) {
+            Packet px, py, pz;
+            for (int i = 0; i < 8; ++i) {
+              px[i] = -bound + (float(std::min(x + i, res - 1)) + 0.5f) * texel;
+            }
+            py.setConstant(-bound + (float(y) + 0.5f) * texel);
+            pz.setConstant(-bound + (float(z) + 0.5f) * texel);
+            const Packet v = bake(px, py, pz).max(0.0f).min(255.0f);
+            unsigned char* row = &volume[(size_t(z) * res + y) * res];
+            for (int i = 0; i < 8 && x + i < res; ++i) {
+              row[x + i] = (unsigned char)v[i];
+            }
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  return volume;
+}
+
+LevelVolume::LevelVolume() :
+  stop(false),
+  requested(-1),
+  finished(-1),
+  ready(-1),
+  texture_level(-1),
+  written_shader(nullptr),
+  written_level(-1) {
+}
+
+LevelVolume::~LevelVolume() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stop = true;
+  }
+  cv.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void LevelVolume::Start(const std::string& save_dir) {
+  if (thread.joinable()) {
+    return;
+  }
+  dir = save_dir + "/volumes";
+  thread = std::thread(&LevelVolume::Run, this);
+}
+
+void LevelVolume::Request(int level) {
+  //Without a tight bound the texels would be too coarse to be worth it
+  if (all_levels[level].IsAnimated() || Scene::FractalBound(all_levels[level].params) >= max_dist) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  if (requested != level) {
+    requested = level;
+    cv.notify_all();
+  }
+}
+
+void LevelVolume::Update() {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (ready >= 0) {
+    texture_level = (texture.loadFromImage(ready_image) ? ready : -1);
+    texture.setSmooth(true);
+    ready_image = sf::Image();
+    ready = -1;
+  }
+}
+
+void LevelVolume::Write(sf::Shader& shader, int level, bool is_static) {
+  const int active = (is_static && level == texture_level ? level : -1);
+  if (&shader == written_shader && active == written_level) {
+    return;
+  }
+  if (active >= 0) {
+    const float bound = Scene::FractalBound(all_levels[active].params);
+    const float rows = float((volume_res + atlas_cols - 1) / atlas_cols);
+    shader.setUniform("iVolume", sf::Glsl::Vec4(float(volume_res), bound, float(atlas_cols), rows));
+    shader.setUniform("iVolumeTex", texture);
+  } else {
+    shader.setUniform("iVolume", sf::Glsl::Vec4(0.0f, 0.0f, 0.0f, 0.0f));
+  }
+  written_shader = &shader;
+  written_level = active;
+}
+
+std::vector<unsigned char> LevelVolume::BakeShadows(const FractalParams& params, int res, int num_threads) {
+  const float bound = Scene::FractalBound(params);
+  return BakeTexels(res, bound, num_threads, [&](const Packet& x, const Packet& y, const Packet& z) -> Packet {
+    //Plain unrelaxed steps, it only runs once per level
+    const Packet k = CpuRenderer::MarchShadow(params, bound, 1.0f, x, y, z, CpuRenderer::Mask::Constant(true));
+    return k.max(0.0f).min(1.0f) * 255.0f + 0.5f;
+  });
+}
+
+std::vector<unsigned char> LevelVolume::BakeDistances(const FractalParams& params, int res, int num_threads) {
+  //Any point the lookup can blend a texel into is at most a texel diagonal away
+  //from its center, so that much is taken off before rounding down
+  const float bound = Scene::FractalBound(params);
+  const float diag = std::sqrt(3.0f) * 2.0f * bound / float(res);
+  return BakeTexels(res, bound, num_threads, [&](const Packet& x, const Packet& y, const Packet& z) -> Packet {
+    return ((Scene::DE(params, x, y, z) - diag) * (255.0f / bound)).floor();
+  });
+}
+
+float LevelVolume::SampleDistance(const std::vector<unsigned char>& distances, int res, float bound, const Eigen::Vector3f& p) {
+  const Eigen::Array3f t = ((p.array() / bound * 0.5f + 0.5f) * float(res) - 0.5f).max(0.0f).min(float(res - 1));
+  const Eigen::Array3i t0 = t.floor().cast<int>();
+  const Eigen::Array3f f = t - t0.cast<float>();
+  float v = 0.0f;
+  for (int i = 0; i < 8; ++i) {
+    const int x = std::min(t0.x() + (i & 1), res - 1);
+    const int y = std::min(t0.y() + ((i >> 1) & 1), res - 1);
+    const int z = std::min(t0.z() + (i >> 2), res - 1);
+    const float w = ((i & 1) ? f.x() : 1.0f - f.x()) * (((i >> 1) & 1) ? f.y() : 1.0f - f.y()) * ((i >> 2) ? f.z() : 1.0f - f.z());
+    v += w * float(distances[(size_t(z) * res + y) * res + x]);
+  }
+  //Filtering is not exact on the GPU, so one step of the encoding is kept spare
+  return std::max(v - 1.0f, 0.0f) * bound / 255.0f;
+}
+
+sf::Image LevelVolume::MakeAtlas(const std::vector<unsigned char>& shadows, const std::vector<unsigned char>& distances, int res) {
+  const int rows = (res + atlas_cols - 1) / atlas_cols;
+  sf::Image atlas;
+  atlas.create(res * atlas_cols, res * rows, sf::Color::Black);
+  for (int z = 0; z < res; ++z) {
+    const int ox = (z % atlas_cols) * res;
+    const int oy = (z / atlas_cols) * res;
+    for (int y = 0; y < res; ++y) {
+      for (int x = 0; x < res; ++x) {
+        const size_t i = (size_t(z) * res + y) * res + x;
+        atlas.setPixel(ox + x, oy + y, sf::Color(shadows[i], distances[i], 0));
+      }
+    }
+  }
+  return atlas;
+}
+
+sf::Uint32 LevelVolume::Key(const FractalParams& params) {
+  const sf::Uint32 header[] = { volume_version, sf::Uint32(volume_res), sf::Uint32(atlas_cols) };
+  const sf::Uint32 hash = FileUtil::Hash(header, sizeof(header));
+  return FileUtil::Hash(params.data(), num_fractal_params * sizeof(float), hash);
+}
+
+void LevelVolume::Run() {
+  const bool has_dir = FileUtil::CreateDir(dir);
+  const int num_threads = std::max(int(std::thread::hardware_concurrency()) - 1, 1);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stop) {
+    if (requested < 0 || requested == finished) {
+      cv.wait(lock);
+      continue;
+    }
+    const int level = requested;
+    lock.unlock();
+
+    //Baking takes a second or two, the shader marches until it is done
+    const FractalParams& params = all_levels[level].params;
+    sf::Image image;
+    if (!has_dir || !image.loadFromFile(FileName(params))) {
+      image = MakeAtlas(BakeShadows(params, volume_res, num_threads), BakeDistances(params, volume_res, num_threads), volume_res);
+      if (has_dir) {
+        image.saveToFile(FileName(params));
+      }
+    }
+
+    lock.lock();
+    finished = level;
+    if (level == requested) {
+      ready_image = image;
+      ready = level;
+    }
+  }
+}
+
+std::string LevelVolume::FileName(const FractalParams& params) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%08x.png", (unsigned int)Key(params));
+  return dir + name;
+}
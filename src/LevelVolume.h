@@ -0,0 +1,74 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "Level.h"
+#include <Eigen/Dense>
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Fields baked for levels that never change, which frag.glsl samples instead
+//of marching. Red holds the light visibility used in place of shadow rays,
+//green a conservative distance bound for taking large steps in open space.
+//The slices are laid out side by side in a 2D texture since GLSL 1.20
+//through SFML has no 3D textures.
+class LevelVolume {
+public:
+  LevelVolume();
+  ~LevelVolume();
+
+  //Baked volumes are cached under the save directory
+  void Start(const std::string& save_dir);
+  //Loads or bakes the volume for a level in the background, animated levels are ignored
+  void Request(int level);
+  //Uploads a finished volume, must be called from the GL thread
+  void Update();
+  //Points the shader at the volume, or back to marching when it is not for this fractal
+  void Write(sf::Shader& shader, int level, bool is_static);
+
+  //Each covers res^3 points over the fractal's bounding cube, x fastest
+  static std::vector<unsigned char> BakeShadows(const FractalParams& params, int res, int num_threads);
+  static std::vector<unsigned char> BakeDistances(const FractalParams& params, int res, int num_threads);
+  //Distance bound at any point in the cube, the same lookup as frag.glsl
+  static float SampleDistance(const std::vector<unsigned char>& distances, int res, float bound, const Eigen::Vector3f& p);
+  //Lays the slices out in rows of atlas_cols
+  static sf::Image MakeAtlas(const std::vector<unsigned char>& shadows, const std::vector<unsigned char>& distances, int res);
+  static sf::Uint32 Key(const FractalParams& params);
+
+private:
+  void Run();
+  std::string FileName(const FractalParams& params) const;
+
+  std::string dir;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stop;
+  int requested;
+  int finished;
+  int ready;
+  sf::Image ready_image;
+
+  //Owned by the GL thread through Update and Write
+  sf::Texture texture;
+  int texture_level;
+  const sf::Shader* written_shader;
+  int written_level;
+};
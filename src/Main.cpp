@@ -21,6 +21,9 @@
 #include "Res.h"
 #include "SelectRes.h"
 #include "Scores.h"
+#include "RenderWorker.h"
+#include "SequenceOptions.h"
+#include "SequenceRenderer.h"
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
 #include <SFML/OpenGL.hpp>
@@ -35,9 +38,22 @@
 
 #if defined(_WIN32)
 int WinMain(HINSTANCE hInstance, HINSTANCE, LPTSTR lpCmdLine, int nCmdShow) {
+  const int argc = __argc;
+  char** argv = __argv;
 #else
 int main(int argc, char *argv[]) {
 #endif
+  //Offline rendering skips the window and menus entirely
+  SequenceOptions sequence;
+  if (!sequence.Parse(argc, argv)) {
+    std::cerr << SequenceOptions::Usage();
+    return 1;
+  } else if (sequence.worker) {
+    return RenderWorker(sequence.worker_host, sequence.worker_port).Run();
+  } else if (sequence.requested) {
+    return SequenceRenderer(sequence).Run();
+  }
+
   Game game;
 
   game.GameLoop();
@@ -0,0 +1,134 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "MarbleProbe.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include <algorithm>
+
+static const unsigned int probe_face_size = 64;
+//Marble radii moved before a single refreshed face is not enough
+static const float probe_jump = 4.0f;
+
+MarbleProbe::MarbleProbe() :
+  enabled(true),
+  created(false),
+  next_face(0),
+  version(0) {
+}
+
+void MarbleProbe::SetEnabled(bool e) {
+  //Faces kept while disabled may be far out of date
+  enabled = e;
+  for (int i = 0; i < num_faces; ++i) {
+    face_state[i].clear();
+  }
+}
+
+void MarbleProbe::Update(sf::Shader& shader, Renderer& renderer, Scene& scene) {
+  if (!enabled) {
+    return;
+  }
+  if (!created) {
+    //Three faces across and two up
+    if (!atlas.create(probe_face_size * 3, probe_face_size * 2)) {
+      enabled = false;
+      return;
+    }
+    atlas.setSmooth(true);
+    created = true;
+  }
+
+  //Everything the faces show, which is all of the scene but the camera
+  const UniformBlock& uniforms = scene.GetUniforms();
+  std::vector<float> state = uniforms.GetValues();
+  const size_t mat_ix = size_t(uniforms.Find("iMat") - uniforms.GetValues().data());
+  std::fill(state.begin() + mat_ix, state.begin() + mat_ix + 16, 0.0f);
+  //Where the shader sees the marble, which is relative to the camera while exploring
+  const float* marble_pos = uniforms.Find("iMarblePos");
+  const Eigen::Vector3f pos(marble_pos[0], marble_pos[1], marble_pos[2]);
+  //Jumps are measured in the world so flying the explorer camera isn't one
+  const Eigen::Vector3f world_pos = scene.GetMarble().GetPosition();
+  const float jump = probe_jump * scene.GetMarble().GetRadius();
+
+  bool jumped = false;
+  for (int i = 0; i < num_faces; ++i) {
+    jumped = jumped || face_state[i].empty() || (face_pos[i] - world_pos).norm() > jump;
+  }
+  bool rendered = false;
+  for (int i = 0; i < num_faces; ++i) {
+    const int face = (next_face + i) % num_faces;
+    if (face_state[face] == state) {
+      continue;
+    }
+    RenderFace(face, shader, renderer, pos);
+    face_state[face] = state;
+    face_pos[face] = world_pos;
+    rendered = true;
+    if (!jumped) {
+      next_face = (face + 1) % num_faces;
+      break;
+    }
+  }
+  if (rendered) {
+    atlas.display();
+    version += 1;
+    //The camera matrix was replaced for the faces
+    scene.InvalidateUniforms();
+    scene.Write(shader);
+  }
+}
+
+void MarbleProbe::Write(sf::Shader& shader) const {
+  bool ready = (enabled && created);
+  for (int i = 0; i < num_faces; ++i) {
+    ready = ready && !face_state[i].empty();
+  }
+  shader.setUniform("iProbeSize", ready ? float(probe_face_size) : 0.0f);
+  if (ready) {
+    shader.setUniform("iProbeTex", atlas.getTexture());
+  }
+}
+
+Eigen::Matrix4f MarbleProbe::FaceMatrix(int face, const Eigen::Vector3f& pos) {
+  const float s = (face % 2 == 0 ? 1.0f : -1.0f);
+  Eigen::Vector3f f, u;
+  if (face < 2) {
+    f = Eigen::Vector3f(s, 0.0f, 0.0f);
+    u = Eigen::Vector3f(0.0f, 1.0f, 0.0f);
+  } else if (face < 4) {
+    f = Eigen::Vector3f(0.0f, s, 0.0f);
+    u = Eigen::Vector3f(0.0f, 0.0f, s);
+  } else {
+    f = Eigen::Vector3f(0.0f, 0.0f, s);
+    u = Eigen::Vector3f(0.0f, 1.0f, 0.0f);
+  }
+
+  //Columns are right, up and backwards like the scene's camera
+  Eigen::Matrix4f mat = Eigen::Matrix4f::Identity();
+  mat.block<3, 1>(0, 0) = f.cross(u);
+  mat.block<3, 1>(0, 1) = u;
+  mat.block<3, 1>(0, 2) = -f;
+  mat.block<3, 1>(0, 3) = pos;
+  return mat;
+}
+
+void MarbleProbe::RenderFace(int face, sf::Shader& shader, Renderer& renderer, const Eigen::Vector3f& pos) {
+  const Eigen::Matrix4f mat = FaceMatrix(face, pos);
+  shader.setUniform("iMat", sf::Glsl::Mat4(mat.data()));
+  const sf::Vector2f origin(float((face % 3) * probe_face_size), float((face / 3) * probe_face_size));
+  renderer.DrawProbeFace(atlas, shader, origin, float(probe_face_size));
+}
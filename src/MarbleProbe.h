@@ -0,0 +1,59 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <Eigen/Dense>
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+class Renderer;
+class Scene;
+
+//Cube of the marble's surroundings rendered from its center, which the glass
+//samples instead of tracing a reflected and a refracted ray per pixel. Faces
+//are refreshed one per frame while the scene changes, and all at once when
+//the marble jumps.
+class MarbleProbe {
+public:
+  static const int num_faces = 6;
+
+  MarbleProbe();
+
+  //Off traces the marble's rays exactly
+  void SetEnabled(bool e);
+  bool IsEnabled() const { return enabled; }
+
+  //Renders stale faces, the scene's uniforms must already be written to the shader
+  void Update(sf::Shader& shader, Renderer& renderer, Scene& scene);
+  //Points the marble at the probe, or back to tracing until every face exists
+  void Write(sf::Shader& shader) const;
+  //Changes whenever a face is rendered
+  int GetVersion() const { return version; }
+
+  //Camera looking out through a face from pos, matches probe_axes in frag.glsl
+  static Eigen::Matrix4f FaceMatrix(int face, const Eigen::Vector3f& pos);
+
+private:
+  void RenderFace(int face, sf::Shader& shader, Renderer& renderer, const Eigen::Vector3f& pos);
+
+  bool enabled;
+  bool created;
+  sf::RenderTexture atlas;
+  int next_face;
+  int version;
+  std::vector<float> face_state[num_faces];
+  Eigen::Vector3f face_pos[num_faces];
+};
@@ -18,6 +18,7 @@
 #include "Level.h"
 #include "Res.h"
 #include "Scores.h"
+#include <cstdio>
 
 int mouse_setting = 0;
 bool music_on = true;
@@ -287,6 +288,62 @@ void Overlays::DrawFPS(sf::RenderWindow& window, int fps) {
   window.draw(text);
 }
 
+void Overlays::DrawDebugLegend(sf::RenderWindow& window, Renderer::DebugMode mode) {
+  sf::Text text;
+  struct TextCharacteristics textInfo;
+  textInfo.str = Renderer::DebugName(mode);
+  textInfo.x = 16;
+  textInfo.y = 16;
+  textInfo.size = 24;
+  textInfo.mono = false;
+  MakeText(textInfo, sf::Color::White, text);
+  window.draw(text);
+
+  //One line per exit type or heatmap stop
+  textInfo.mono = true;
+  textInfo.size = 20;
+  const int num_lines = (mode == Renderer::DEBUG_EXIT ? Renderer::NUM_EXIT_TYPES : 5);
+  for (int i = 0; i < num_lines; ++i) {
+    std::string line_str;
+    sf::Color col;
+    if (mode == Renderer::DEBUG_EXIT) {
+      line_str = Renderer::ExitName(Renderer::ExitType(i));
+      col = Renderer::ExitColor(Renderer::ExitType(i));
+    } else {
+      const float t = float(i) / float(num_lines - 1);
+      line_str = std::to_string(int(t * Renderer::DebugScale(mode))) + (i == num_lines - 1 ? "+" : "");
+      col = Renderer::Heatmap(t);
+    }
+    textInfo.str = line_str.c_str();
+    textInfo.y = 50.0f + 24.0f * float(i);
+    MakeText(textInfo, col, text);
+    window.draw(text);
+  }
+}
+
+void Overlays::DrawGpuTimes(sf::RenderWindow& window, const GpuTimer& timer, float frame_ms) {
+  //Right aligned in the top corner, GPU passes then the whole frame
+  sf::Text text;
+  struct TextCharacteristics textInfo;
+  textInfo.x = 1264;
+  textInfo.size = 20;
+  textInfo.mono = true;
+  char line[64];
+  for (int i = 0; i <= GpuTimer::NUM_PASSES; ++i) {
+    if (i < GpuTimer::NUM_PASSES) {
+      const GpuTimer::Pass pass = GpuTimer::Pass(i);
+      snprintf(line, sizeof(line), "%s %5.2fms", GpuTimer::PassName(pass), timer.GetMs(pass));
+    } else {
+      snprintf(line, sizeof(line), "frame %5.2fms", frame_ms);
+    }
+    textInfo.str = line;
+    textInfo.y = 16.0f + 24.0f * float(i);
+    MakeText(textInfo, sf::Color::White, text);
+    text.setOrigin(text.getLocalBounds().width, 0.0f);
+    window.draw(text);
+  }
+}
+
 void Overlays::DrawPaused(sf::RenderWindow& window) {
   for (int i = PAUSED; i <= MOUSE; ++i) {
     window.draw(all_text[i]);
@@ -328,7 +385,20 @@ void Overlays::DrawCredits(sf::RenderWindow& window) {
   window.draw(text);
 }
 
-void Overlays::DrawLevels(sf::RenderWindow& window) {
+void Overlays::DrawLevels(sf::RenderWindow& window, const ThumbnailCache& thumbnails) {
+  //Draw the previews behind the names, locked levels stay hidden
+  for (int i = 0; i < num_levels; ++i) {
+    const sf::Texture* thumbnail = thumbnails.Get(i);
+    if (thumbnail && high_scores.HasUnlocked(i)) {
+      const sf::Vector2u size = thumbnail->getSize();
+      sf::Sprite sprite(*thumbnail);
+      sprite.setOrigin(size.x * 0.5f, size.y * 0.5f);
+      sprite.setScale(draw_scale, draw_scale);
+      sprite.setPosition((240.0f + float(i % 3) * 400.0f) * draw_scale, (110.0f + float(i / 3) * 120.0f) * draw_scale);
+      sprite.setColor(sf::Color(255, 255, 255, 160));
+      window.draw(sprite);
+    }
+  }
   //Draw the level names
   for (int i = L0; i <= BACK2; ++i) {
     window.draw(all_text[i]);
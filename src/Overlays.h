@@ -17,6 +17,9 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include "Renderer.h"
+#include "GpuTimer.h"
+#include "ThumbnailCache.h"
 
 extern int mouse_setting;
 extern bool music_on;
@@ -73,10 +76,12 @@ public:
   void DrawTimer(sf::RenderWindow& window, int t, bool finished);
   void DrawLevelDesc(sf::RenderWindow& window, int level);
   void DrawFPS(sf::RenderWindow& window, int fps);
+  void DrawDebugLegend(sf::RenderWindow& window, Renderer::DebugMode mode);
+  void DrawGpuTimes(sf::RenderWindow& window, const GpuTimer& timer, float frame_ms);
   void DrawPaused(sf::RenderWindow& window);
   void DrawArrow(sf::RenderWindow& window, const sf::Vector3f& v3);
   void DrawCredits(sf::RenderWindow& window);
-  void DrawLevels(sf::RenderWindow& window);
+  void DrawLevels(sf::RenderWindow& window, const ThumbnailCache& thumbnails);
 
   bool* getAllHover();
 
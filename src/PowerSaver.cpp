@@ -0,0 +1,66 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "PowerSaver.h"
+#include <sstream>
+
+//Render scale and frame rate for each state
+static const float state_scale[PowerSaver::NUM_STATES] = { 1.0f, 0.5f, 0.5f };
+static const float state_fps[PowerSaver::NUM_STATES] = { 60.0f, 20.0f, 10.0f };
+static const char* state_names[PowerSaver::NUM_STATES] = { "active", "idle", "unfocused" };
+
+PowerSaver::PowerSaver(float _idle_time) :
+  state(ACTIVE),
+  idle_time(_idle_time),
+  since_input(0.0f) {
+  for (int i = 0; i < NUM_STATES; ++i) {
+    time[i] = 0.0f;
+    frames[i] = 0;
+  }
+}
+
+PowerSaver::State PowerSaver::Update(float dt, bool has_focus, bool had_input) {
+  time[state] += dt;
+  since_input = (had_input ? 0.0f : since_input + dt);
+
+  //Input always restores full quality right away
+  if (!has_focus) {
+    state = UNFOCUSED;
+  } else if (since_input >= idle_time) {
+    state = IDLE;
+  } else {
+    state = ACTIVE;
+  }
+  return state;
+}
+
+float PowerSaver::GetScale() const {
+  return state_scale[state];
+}
+
+float PowerSaver::GetFPS() const {
+  return state_fps[state];
+}
+
+std::string PowerSaver::Report() const {
+  std::ostringstream report;
+  report << "Power states:";
+  for (int i = 0; i < NUM_STATES; ++i) {
+    report << (i > 0 ? "," : "") << " " << state_names[i] << " " <<
+      time[i] << "s (" << frames[i] << " frames)";
+  }
+  return report.str();
+}
@@ -0,0 +1,49 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <string>
+
+//Lowers render cost while nobody is using the game
+class PowerSaver {
+public:
+  enum State {
+    ACTIVE,
+    IDLE,
+    UNFOCUSED,
+    NUM_STATES
+  };
+
+  PowerSaver(float _idle_time);
+
+  //Call once per loop with the elapsed seconds, returns the new state
+  State Update(float dt, bool has_focus, bool had_input);
+  void AddFrame() { frames[state] += 1; }
+
+  State GetState() const { return state; }
+  float GetScale() const;
+  float GetFPS() const;
+  float GetTime(State s) const { return time[s]; }
+  int GetFrames(State s) const { return frames[s]; }
+  std::string Report() const;
+
+private:
+  State state;
+  float idle_time;
+  float since_input;
+  float time[NUM_STATES];
+  int frames[NUM_STATES];
+};
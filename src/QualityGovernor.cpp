@@ -0,0 +1,95 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "QualityGovernor.h"
+#include <algorithm>
+#include <cmath>
+
+//Over the high band the detail drops, under the low band it may rise again
+static const float band_low = 0.8f;
+static const float band_high = 1.05f;
+//Dropping is fast to protect the frame rate, rising is slow and only after a
+//stretch of headroom so the detail does not pump around the target
+static const float max_drop = 0.15f;
+static const float min_drop = 0.02f;
+static const float raise_step = 0.05f;
+static const int headroom_time = 30;
+//Range of each setting between full and no detail
+static const float min_march_frac = 0.25f;
+static const float max_dist_factor = 10.0f;
+static const float max_sharpness_factor = 4.0f;
+
+QualityGovernor::QualityGovernor(float _target_ms) :
+  filter(_target_ms, band_low, band_high),
+  full_max_marches(1000.0f),
+  full_min_dist(1e-5f),
+  full_shadow_sharpness(10.0f),
+  detail(1.0f),
+  headroom_frames(0) {
+}
+
+void QualityGovernor::SetFullDetail(float max_marches, float min_dist, float shadow_sharpness) {
+  full_max_marches = max_marches;
+  full_min_dist = min_dist;
+  full_shadow_sharpness = shadow_sharpness;
+}
+
+float QualityGovernor::Update(float frame_ms) {
+  if (!filter.Update(frame_ms)) {
+    return detail;
+  }
+
+  float new_detail = detail;
+  if (filter.IsOver()) {
+    headroom_frames = 0;
+    new_detail = detail - std::min(std::max(filter.GetRatio() - 1.0f, min_drop), max_drop);
+  } else if (filter.IsUnder()) {
+    headroom_frames += 1;
+    if (headroom_frames >= headroom_time) {
+      headroom_frames = 0;
+      new_detail = detail + raise_step;
+    }
+  } else {
+    //Hold while close enough to the target
+    headroom_frames = 0;
+  }
+
+  new_detail = std::min(std::max(new_detail, 0.0f), 1.0f);
+  if (new_detail != detail) {
+    detail = new_detail;
+    filter.Settle();
+  }
+  return detail;
+}
+
+void QualityGovernor::Reset() {
+  detail = 1.0f;
+  filter.Reset();
+  headroom_frames = 0;
+}
+
+float QualityGovernor::GetMaxMarches() const {
+  const float frac = min_march_frac + (1.0f - min_march_frac) * detail;
+  return std::max(std::floor(full_max_marches * frac), 1.0f);
+}
+
+float QualityGovernor::GetMinDist() const {
+  return full_min_dist * std::pow(max_dist_factor, 1.0f - detail);
+}
+
+float QualityGovernor::GetShadowSharpness() const {
+  return full_shadow_sharpness * std::pow(max_sharpness_factor, 1.0f - detail);
+}
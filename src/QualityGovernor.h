@@ -0,0 +1,49 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "FrameTimeFilter.h"
+
+//Trades march detail for time at a fixed resolution, from measured frame times
+class QualityGovernor {
+public:
+  QualityGovernor(float _target_ms);
+
+  //The quality preset's values, used at full detail
+  void SetFullDetail(float max_marches, float min_dist, float shadow_sharpness);
+
+  //Feed the render time of the last frame, returns the detail for the next one
+  float Update(float frame_ms);
+  void Reset();
+
+  //1 is the preset's full detail, 0 the coarsest
+  float GetDetail() const { return detail; }
+  float GetTarget() const { return filter.GetTarget(); }
+  float GetSmoothTime() const { return filter.GetSmoothTime(); }
+
+  //Fewer marches, a coarser surface and sharper, cheaper shadows as the detail drops
+  float GetMaxMarches() const;
+  float GetMinDist() const;
+  float GetShadowSharpness() const;
+
+private:
+  FrameTimeFilter filter;
+  float full_max_marches;
+  float full_min_dist;
+  float full_shadow_sharpness;
+  float detail;
+  int headroom_frames;
+};
@@ -0,0 +1,133 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "RenderWorker.h"
+#include "FrameCapture.h"
+#include "Renderer.h"
+#include "Res.h"
+#include "Scene.h"
+#include "ShaderVariants.h"
+#include "UniformBlock.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+static const float connect_timeout = 10.0f;
+
+RenderWorker::RenderWorker(const std::string& host, unsigned short port) :
+  host(host),
+  port(port) {
+}
+
+int RenderWorker::Run() {
+  sf::TcpSocket socket;
+  if (socket.connect(host, port, sf::seconds(connect_timeout)) != sf::Socket::Done) {
+    std::cerr << "Failed to connect to " << host << ":" << port << std::endl;
+    return 1;
+  }
+  sf::Packet hello;
+  hello << sf::Uint8(MSG_HELLO) << render_protocol;
+  socket.send(hello);
+
+  //Grows to the largest tile, smaller ones use its bottom-left corner
+  sf::RenderTexture target;
+  if (!sf::Shader::isAvailable() || !target.create(1, 1)) {
+    std::cerr << "OpenGL shaders are not available" << std::endl;
+    return 1;
+  }
+  target.setActive(true);
+  ShaderVariants shader_variants;
+  if (!shader_variants.Load(vert_glsl, frag_glsl, presets_txt)) {
+    std::cerr << "Unable to load shaders" << std::endl;
+    return 1;
+  }
+  Renderer renderer;
+  UniformBlock uniforms = Scene::CreateUniforms();
+
+  int num_tiles = 0;
+  sf::Clock clock;
+  while (true) {
+    sf::Packet packet;
+    if (socket.receive(packet) != sf::Socket::Done) {
+      std::cerr << "Lost the coordinator" << std::endl;
+      return 1;
+    }
+    sf::Uint8 type = 0;
+    packet >> type;
+    if (type == MSG_QUIT) {
+      break;
+    } else if (type != MSG_TILE) {
+      continue;
+    }
+
+    sf::Int32 tile_id = 0;
+    sf::Uint32 frame_w = 0, frame_h = 0, x = 0, y = 0, w = 0, h = 0;
+    sf::Uint8 ss = 1;
+    std::string quality, saved_uniforms;
+    packet >> tile_id >> frame_w >> frame_h >> x >> y >> w >> h >> ss >> quality >> saved_uniforms;
+    const int preset = shader_variants.Find(quality);
+    sf::Shader* shader = (preset >= 0 ? shader_variants.Get(preset) : nullptr);
+    if (!packet || !shader || ss == 0) {
+      std::cerr << "Bad tile request" << std::endl;
+      return 1;
+    }
+
+    //Render at the supersampled size
+    const unsigned int tw = w * ss;
+    const unsigned int th = h * ss;
+    if (target.getSize().x < tw || target.getSize().y < th) {
+      if (!target.create(std::max(target.getSize().x, tw), std::max(target.getSize().y, th))) {
+        std::cerr << "Failed to create a " << tw << "x" << th << " render target" << std::endl;
+        return 1;
+      }
+      target.setActive(true);
+    }
+    std::istringstream uniforms_in(saved_uniforms);
+    uniforms.Load(uniforms_in);
+    uniforms.Upload(*shader);
+
+    //Tiles count rows from the top but the shader counts from the bottom
+    renderer.SetTile(sf::Vector2f(float(x * ss), float((frame_h - y - h) * ss)),
+                     sf::Vector2f(float(frame_w * ss), float(frame_h * ss)));
+    renderer.Draw(target, *shader, sf::Vector2f(float(tw), float(th)));
+    target.display();
+
+    //The tile is the bottom-left corner of the image
+    const sf::Image image = target.getTexture().copyToImage();
+    const sf::Uint8* src = image.getPixelsPtr();
+    const unsigned int image_w = image.getSize().x;
+    const unsigned int top = image.getSize().y - th;
+    std::vector<unsigned char> pixels(size_t(tw) * size_t(th) * 4);
+    for (unsigned int row = 0; row < th; ++row) {
+      std::copy(src + (size_t(top + row) * image_w) * 4, src + (size_t(top + row) * image_w + tw) * 4, &pixels[size_t(row) * tw * 4]);
+    }
+    unsigned int out_w = tw, out_h = th;
+    FrameCapture::Downsample(pixels, out_w, out_h, ss);
+
+    sf::Packet result;
+    result << sf::Uint8(MSG_RESULT) << tile_id << std::string(pixels.begin(), pixels.end());
+    if (socket.send(result) != sf::Socket::Done) {
+      std::cerr << "Lost the coordinator" << std::endl;
+      return 1;
+    }
+    num_tiles += 1;
+  }
+
+  const float secs = clock.getElapsedTime().asSeconds();
+  std::cout << "Rendered " << num_tiles << " tiles in " << secs << "s (" << float(num_tiles) / secs << " tiles/s)" << std::endl;
+  return 0;
+}
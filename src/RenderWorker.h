@@ -0,0 +1,41 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Network.hpp>
+#include <string>
+
+//Packet types between a --listen coordinator and its workers
+enum RenderMessage {
+  MSG_HELLO,  //Worker: protocol version
+  MSG_TILE,   //Coordinator: tile id, frame size, tile rect, supersample, quality, saved uniforms
+  MSG_RESULT, //Worker: tile id, RGBA pixels top row first
+  MSG_QUIT
+};
+static const sf::Uint32 render_protocol = 1;
+
+//Renders tiles for a remote coordinator until it says to quit
+class RenderWorker {
+public:
+  RenderWorker(const std::string& host, unsigned short port);
+
+  //Returns the process exit code
+  int Run();
+
+private:
+  std::string host;
+  unsigned short port;
+};
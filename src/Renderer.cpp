@@ -0,0 +1,377 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Renderer.h"
+#include "GLExt.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+//Luminance or relative depth change that counts as an edge
+static const float aa_threshold = 0.1f;
+//Average number of extra rays per pixel for the whole frame
+static const float aa_budget = 0.2f;
+//Disables the frame budget when the edge fraction is unknown
+static const float aa_unlimited = 1000.0f;
+//Sharpening strength from 0 to 1 for the upscale pass
+static const float upscale_sharpness = 0.5f;
+//Weight of the previous frame with temporal accumulation
+static const float history_weight = 0.6f;
+//Jittered samples averaged into a static view before it is only reused
+static const int progressive_samples = 16;
+//Values that map to the top of the heatmap
+static const float debug_max_steps = 200.0f;
+static const float debug_max_calls = 500.0f;
+//Divides the summed samples by their count when presenting the cache
+static const char* cache_average_glsl =
+  "uniform sampler2D iSum;\n"
+  "uniform float iSamples;\n"
+  "void main() {\n"
+  "  gl_FragColor = texture2D(iSum, gl_TexCoord[0].xy) / iSamples;\n"
+  "}\n";
+
+Renderer::Renderer() :
+  adaptive_aa(false),
+  tiled(false),
+  debug_mode(DEBUG_OFF),
+  has_mipmaps(false),
+  aa_size(0, 0),
+  temporal(false),
+  history_valid(false),
+  history_ix(0),
+  view_moving(false),
+  cache_shader(nullptr),
+  cache_size(0, 0),
+  cache_samples(0),
+  cache_failed(false),
+  frame_cached(false) {
+  //Placeholder bound to the samplers while their texture is the target
+  empty_tex.create(1, 1);
+}
+
+static float Halton(int i, int base) {
+  float result = 0.0f;
+  float f = 1.0f;
+  while (i > 0) {
+    f /= float(base);
+    result += f * float(i % base);
+    i /= base;
+  }
+  return result;
+}
+
+void Renderer::SetTile(const sf::Vector2f& offset, const sf::Vector2f& frame_size) {
+  tiled = true;
+  tile_offset = offset;
+  tile_frame = frame_size;
+}
+
+void Renderer::SetViewState(const std::vector<float>& state) {
+  if (state != view_state) {
+    view_state = state;
+    view_moving = true;
+  }
+}
+
+void Renderer::Draw(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size) {
+  shader.setUniform("iDebug", sf::Glsl::Vec3(float(debug_mode), 0.0f, DebugScale(debug_mode)));
+  shader.setUniform("iJitter", sf::Glsl::Vec2(0.0f, 0.0f));
+  frame_cached = false;
+  const sf::Vector2u frame_size((unsigned int)size.x, (unsigned int)size.y);
+  if (&shader != cache_shader || frame_size != cache_size) {
+    cache_shader = &shader;
+    cache_size = frame_size;
+    cache_samples = 0;
+  }
+
+  //Moving views and tiles are only seen once, so they go straight to the target
+  const bool moving = view_moving;
+  view_moving = false;
+  if (moving || tiled || debug_mode != DEBUG_OFF || !CreateCache(frame_size.x, frame_size.y)) {
+    cache_samples = 0;
+    DrawFrame(target, shader, size, adaptive_aa);
+    return;
+  }
+  const int cache_h = int(cache_acc.getSize().y);
+  const sf::IntRect corner(0, cache_h - int(frame_size.y), int(frame_size.x), int(frame_size.y));
+
+  //Keep adding jittered samples while the view stays the same
+  if (cache_samples < progressive_samples) {
+    if (cache_samples > 0) {
+      const float jx = Halton(cache_samples, 2) - 0.5f;
+      const float jy = Halton(cache_samples, 3) - 0.5f;
+      shader.setUniform("iJitter", sf::Glsl::Vec2(jx, jy));
+    }
+    DrawFrame(cache_frame, shader, size, adaptive_aa && cache_samples == 0);
+    cache_frame.display();
+    shader.setUniform("iJitter", sf::Glsl::Vec2(0.0f, 0.0f));
+
+    //Exact float sum of all samples so far
+    sf::Sprite sample(cache_frame.getTexture(), corner);
+    sample.setPosition(0.0f, float(corner.top));
+    sf::RenderStates states = sf::RenderStates::Default;
+    states.blendMode = (cache_samples == 0 ? sf::BlendNone :
+                        sf::BlendMode(sf::BlendMode::One, sf::BlendMode::One, sf::BlendMode::Add));
+    cache_acc.draw(sample, states);
+    cache_acc.display();
+    cache_samples += 1;
+  } else {
+    frame_cached = true;
+  }
+
+  //Present the average in the bottom-left corner of the target
+  cache_average.setUniform("iSum", sf::Shader::CurrentTexture);
+  cache_average.setUniform("iSamples", float(cache_samples));
+  sf::Sprite frame(cache_acc.getTexture(), corner);
+  frame.setPosition(0.0f, float(target.getSize().y) - size.y);
+  sf::RenderStates states = sf::RenderStates::Default;
+  states.blendMode = sf::BlendNone;
+  states.shader = &cache_average;
+  target.draw(frame, states);
+}
+
+void Renderer::DrawFrame(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size, bool aa) {
+  if (!aa || !CreateTargets((unsigned int)size.x, (unsigned int)size.y)) {
+    DrawPass(target, shader, size, 0.0f);
+    return;
+  }
+
+  //First pass renders one sample per pixel with depth in alpha
+  shader.setUniform("iAAColor", empty_tex);
+  shader.setUniform("iAAEdges", empty_tex);
+  DrawPass(aa_color, shader, size, 1.0f);
+  aa_color.display();
+
+  //Second pass marks edge pixels, the top mip gives the edge fraction
+  shader.setUniform("iAAColor", aa_color.getTexture());
+  shader.setUniform("iAAThreshold", aa_threshold);
+  DrawPass(aa_edges, shader, size, 2.0f);
+  aa_edges.display();
+  has_mipmaps = aa_edges.generateMipmap();
+
+  //Final pass adds extra samples on edges within the frame budget
+  shader.setUniform("iAAEdges", aa_edges.getTexture());
+  shader.setUniform("iAABudget", has_mipmaps ? aa_budget : aa_unlimited);
+  DrawPass(target, shader, size, 3.0f);
+  shader.setUniform("iAAPass", 0.0f);
+}
+
+void Renderer::Upscale(sf::RenderTarget& target, sf::Shader& shader, const sf::Texture& source, const sf::Vector2f& size) {
+  const sf::Vector2f target_size(target.getSize());
+  shader.setUniform("iResolution", target_size);
+  shader.setUniform("iSource", source);
+  shader.setUniform("iSourceSize", size);
+  shader.setUniform("iSourceTexSize", sf::Vector2f(source.getSize()));
+  shader.setUniform("iSharpness", upscale_sharpness);
+  if (!temporal) {
+    shader.setUniform("iHistory", empty_tex);
+    shader.setUniform("iHistoryWeight", 0.0f);
+    DrawQuad(target, shader, target_size);
+    return;
+  }
+
+  //Ping-pong between two history targets the size of the output
+  if (history[0].getSize() != target.getSize()) {
+    if (!history[0].create(target.getSize().x, target.getSize().y) ||
+        !history[1].create(target.getSize().x, target.getSize().y)) {
+      temporal = false;
+      Upscale(target, shader, source, size);
+      return;
+    }
+    history_valid = false;
+  }
+  sf::RenderTexture& cur = history[history_ix];
+  const sf::RenderTexture& prev = history[1 - history_ix];
+  shader.setUniform("iHistory", prev.getTexture());
+  shader.setUniform("iHistoryWeight", history_valid ? history_weight : 0.0f);
+  DrawQuad(cur, shader, target_size);
+  cur.display();
+  history_valid = true;
+  history_ix = 1 - history_ix;
+
+  sf::RenderStates states = sf::RenderStates::Default;
+  states.blendMode = sf::BlendNone;
+  target.draw(sf::Sprite(cur.getTexture()), states);
+}
+
+void Renderer::DrawPass(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size, float pass) {
+  shader.setUniform("iAAPass", pass);
+  shader.setUniform("iResolution", size);
+  if (tiled) {
+    shader.setUniform("iTile", sf::Glsl::Vec4(tile_offset.x, tile_offset.y, tile_frame.x, tile_frame.y));
+  } else {
+    shader.setUniform("iTile", sf::Glsl::Vec4(0.0f, 0.0f, size.x, size.y));
+  }
+  DrawQuad(target, shader, size);
+}
+
+void Renderer::DrawProbeFace(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& origin, float size) {
+  //gl_FragCoord includes the origin, the tile offset takes it back out
+  shader.setUniform("iAAPass", 4.0f);
+  shader.setUniform("iResolution", sf::Glsl::Vec2(size, size));
+  shader.setUniform("iTile", sf::Glsl::Vec4(-origin.x, -origin.y, size, size));
+  shader.setUniform("iDebug", sf::Glsl::Vec3(0.0f, 0.0f, 0.0f));
+  //The probe is the target, so it must not be bound for sampling
+  shader.setUniform("iProbeTex", empty_tex);
+  DrawQuad(target, shader, sf::Vector2f(size, size), origin);
+}
+
+void Renderer::DrawQuad(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size, const sf::Vector2f& origin) {
+  sf::RenderStates states = sf::RenderStates::Default;
+  states.shader = &shader;
+  states.blendMode = sf::BlendNone;
+
+  //vert.glsl maps the quad to the whole viewport, so a viewport on the
+  //bottom-left corner keeps gl_FragCoord starting at 0 for smaller sizes
+  const sf::Vector2f target_size(target.getSize());
+  sf::View view(sf::FloatRect(0, 0, size.x, size.y));
+  view.setViewport(sf::FloatRect(origin.x / target_size.x, 1.0f - (origin.y + size.y) / target_size.y, size.x / target_size.x, size.y / target_size.y));
+  target.setView(view);
+
+  sf::RectangleShape rect;
+  rect.setSize(size);
+  rect.setPosition(0, 0);
+  target.draw(rect, states);
+  target.setView(target.getDefaultView());
+}
+
+std::vector<unsigned short> Renderer::ReadDebug(sf::Shader& shader, const sf::Vector2f& size, DebugMode mode) {
+  sf::RenderTexture counts;
+  std::vector<unsigned short> result;
+  if (!counts.create((unsigned int)size.x, (unsigned int)size.y)) {
+    return result;
+  }
+  shader.setUniform("iDebug", sf::Glsl::Vec3(float(mode), 1.0f, 0.0f));
+  DrawPass(counts, shader, size, 0.0f);
+  counts.display();
+  shader.setUniform("iDebug", sf::Glsl::Vec3(float(debug_mode), 0.0f, DebugScale(debug_mode)));
+
+  //Values are packed into the red and green channels
+  const sf::Image image = counts.getTexture().copyToImage();
+  const sf::Uint8* pixels = image.getPixelsPtr();
+  result.resize(size_t(image.getSize().x) * size_t(image.getSize().y));
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i] = (unsigned short)(pixels[i*4] * 256 + pixels[i*4 + 1]);
+  }
+  return result;
+}
+
+bool Renderer::DumpDebug(sf::Shader& shader, const sf::Vector2f& size, const std::string& fname, const std::string& comment) {
+  const DebugMode mode = (debug_mode == DEBUG_OFF ? DEBUG_DE_CALLS : debug_mode);
+  const std::vector<unsigned short> values = ReadDebug(shader, size, mode);
+  if (values.empty()) {
+    return false;
+  }
+  std::ofstream fout(fname, std::ios::binary);
+  if (!fout) {
+    return false;
+  }
+  fout << "P5\n# " << DebugName(mode) << "\n# " << comment << "\n";
+  fout << (unsigned int)size.x << " " << (unsigned int)size.y << "\n65535\n";
+  for (size_t i = 0; i < values.size(); ++i) {
+    fout.put(char(values[i] >> 8));
+    fout.put(char(values[i] & 0xFF));
+  }
+  return bool(fout);
+}
+
+float Renderer::DebugScale(DebugMode mode) {
+  if (mode == DEBUG_DE_CALLS) {
+    return debug_max_calls;
+  } else if (mode == DEBUG_EXIT) {
+    return float(NUM_EXIT_TYPES - 1);
+  }
+  return debug_max_steps;
+}
+
+const char* Renderer::DebugName(DebugMode mode) {
+  switch (mode) {
+  case DEBUG_VIEW_STEPS: return "View ray steps";
+  case DEBUG_SHADOW_STEPS: return "Shadow ray steps";
+  case DEBUG_DE_CALLS: return "DE calls";
+  case DEBUG_EXIT: return "Early exit";
+  default: return "Off";
+  }
+}
+
+sf::Color Renderer::Heatmap(float t) {
+  //Blue to green to red
+  t = std::min(std::max(t, 0.0f), 1.0f);
+  const float r = std::min(std::max(t*4.0f - 2.0f, 0.0f), 1.0f);
+  const float g = std::min(std::max(2.0f - std::abs(t*4.0f - 2.0f), 0.0f), 1.0f);
+  const float b = std::min(std::max(2.0f - t*4.0f, 0.0f), 1.0f);
+  return sf::Color(sf::Uint8(r * 255.0f), sf::Uint8(g * 255.0f), sf::Uint8(b * 255.0f));
+}
+
+sf::Color Renderer::ExitColor(ExitType e) {
+  switch (e) {
+  case EXIT_SURFACE: return sf::Color::Green;
+  case EXIT_OBJECT: return sf::Color::White;
+  case EXIT_BOUND: return sf::Color::Blue;
+  case EXIT_CLIPPED: return sf::Color::Cyan;
+  default: return sf::Color::Red;
+  }
+}
+
+const char* Renderer::ExitName(ExitType e) {
+  switch (e) {
+  case EXIT_SURFACE: return "Hit fractal";
+  case EXIT_OBJECT: return "Hit marble/flag";
+  case EXIT_BOUND: return "Left bound";
+  case EXIT_CLIPPED: return "Missed bound";
+  default: return "Max marches";
+  }
+}
+
+bool Renderer::CreateCache(unsigned int width, unsigned int height) {
+  //Only grows, smaller frames use the bottom-left corner so resolution changes never reallocate
+  const sf::Vector2u old_size = cache_acc.getSize();
+  if (cache_failed || (old_size.x >= width && old_size.y >= height)) {
+    return !cache_failed;
+  }
+  width = std::max(width, old_size.x);
+  height = std::max(height, old_size.y);
+  cache_samples = 0;
+  GLExt::Load();
+  if (!GLExt::HasFloatTexture() || !cache_frame.create(width, height) || !cache_acc.create(width, height) ||
+      !cache_average.loadFromMemory(cache_average_glsl, sf::Shader::Fragment)) {
+    cache_failed = true;
+    return false;
+  }
+  cache_frame.setSmooth(false);
+  cache_acc.setSmooth(false);
+
+  //SFML only makes 8 bit targets, the sum of up to progressive_samples frames needs floats
+  cache_acc.setActive(true);
+  sf::Texture::bind(&cache_acc.getTexture());
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+  sf::Texture::bind(nullptr);
+  return true;
+}
+
+bool Renderer::CreateTargets(unsigned int width, unsigned int height) {
+  if (aa_size.x == width && aa_size.y == height) {
+    return true;
+  }
+  if (!aa_color.create(width, height) || !aa_edges.create(width, height)) {
+    aa_size = sf::Vector2u(0, 0);
+    return false;
+  }
+  aa_color.setSmooth(false);
+  aa_edges.setSmooth(false);
+  aa_size = sf::Vector2u(width, height);
+  return true;
+}
@@ -0,0 +1,119 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+class Renderer {
+public:
+  //Per-pixel cost views, must match debug_output() in frag.glsl
+  enum DebugMode {
+    DEBUG_OFF,
+    DEBUG_VIEW_STEPS,
+    DEBUG_SHADOW_STEPS,
+    DEBUG_DE_CALLS,
+    DEBUG_EXIT,
+    NUM_DEBUG_MODES
+  };
+
+  //Early exit codes reported by DEBUG_EXIT
+  enum ExitType {
+    EXIT_SURFACE,
+    EXIT_OBJECT,
+    EXIT_BOUND,
+    EXIT_CLIPPED,
+    EXIT_MARCHES,
+    NUM_EXIT_TYPES
+  };
+
+  Renderer();
+
+  //Draws the fractal shader over the bottom-left size pixels of the target
+  void Draw(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size);
+
+  //While the state matches the last frame, the cached frame is refined and reused
+  void SetViewState(const std::vector<float>& state);
+  int GetCacheSamples() const { return cache_samples; }
+  //True when the last Draw only presented the cache without running the shader
+  bool IsFrameCached() const { return frame_cached; }
+
+  //Following draws are one tile of a larger frame, offset from its bottom-left corner
+  void SetTile(const sf::Vector2f& offset, const sf::Vector2f& frame_size);
+  void ClearTile() { tiled = false; }
+
+  //Renders one size by size face of the marble probe at origin from the target's bottom-left corner
+  void DrawProbeFace(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& origin, float size);
+
+  //Adaptive anti-aliasing only traces extra rays on detected edges
+  void SetAdaptiveAA(bool enabled) { adaptive_aa = enabled; cache_samples = 0; }
+  bool IsAdaptiveAA() const { return adaptive_aa; }
+
+  //Stretches the bottom-left size pixels of source over the target with sharpening
+  void Upscale(sf::RenderTarget& target, sf::Shader& shader, const sf::Texture& source, const sf::Vector2f& size);
+
+  //Temporal accumulation blends each upscaled frame with the last one
+  void SetTemporal(bool enabled) { temporal = enabled; history_valid = false; }
+  bool IsTemporal() const { return temporal; }
+
+  void SetDebugMode(DebugMode mode) { debug_mode = mode; cache_samples = 0; }
+  DebugMode GetDebugMode() const { return debug_mode; }
+
+  //Renders the raw per-pixel values of a debug mode, top row first
+  std::vector<unsigned short> ReadDebug(sf::Shader& shader, const sf::Vector2f& size, DebugMode mode);
+  //Saves the current debug mode's values as a 16 bit PGM
+  bool DumpDebug(sf::Shader& shader, const sf::Vector2f& size, const std::string& fname, const std::string& comment);
+
+  //Heatmap colors, hard-coded to match the shader
+  static float DebugScale(DebugMode mode);
+  static const char* DebugName(DebugMode mode);
+  static sf::Color Heatmap(float t);
+  static sf::Color ExitColor(ExitType e);
+  static const char* ExitName(ExitType e);
+
+private:
+  void DrawFrame(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size, bool aa);
+  void DrawPass(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size, float pass);
+  void DrawQuad(sf::RenderTarget& target, sf::Shader& shader, const sf::Vector2f& size, const sf::Vector2f& origin=sf::Vector2f(0.0f, 0.0f));
+  bool CreateTargets(unsigned int width, unsigned int height);
+  bool CreateCache(unsigned int width, unsigned int height);
+
+  bool adaptive_aa;
+  bool tiled;
+  sf::Vector2f tile_offset;
+  sf::Vector2f tile_frame;
+  DebugMode debug_mode;
+  bool has_mipmaps;
+  sf::Vector2u aa_size;
+  sf::RenderTexture aa_color;
+  sf::RenderTexture aa_edges;
+  bool temporal;
+  bool history_valid;
+  int history_ix;
+  sf::RenderTexture history[2];
+  std::vector<float> view_state;
+  bool view_moving;
+  const sf::Shader* cache_shader;
+  sf::Vector2u cache_size;
+  int cache_samples;
+  bool cache_failed;
+  bool frame_cached;
+  sf::RenderTexture cache_frame;
+  sf::RenderTexture cache_acc;
+  sf::Shader cache_average;
+  sf::Texture empty_tex;
+};
@@ -19,6 +19,8 @@
 
 static const char vert_glsl[] = "assets/vert.glsl";
 static const char frag_glsl[] = "assets/frag.glsl";
+static const char upscale_glsl[] = "assets/upscale.glsl";
+static const char presets_txt[] = "assets/presets.txt";
 static const char Orbitron_Bold_ttf[] = "assets/Orbitron-Bold.ttf";
 static const char Inconsolata_Bold_ttf[] = "assets/Inconsolata-Bold.ttf";
 static const char menu_ogg[] = "assets/menu.ogg";
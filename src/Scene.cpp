@@ -42,6 +42,69 @@ static const int fractal_iters = 16;
 static const float gravity = 0.005f;
 static const float ground_ratio = 1.15f;
 static const int mus_switch_lev = 9;
+static const float bound_margin = 0.01f;
+static const float bound_none = 1000.0f;
+static const float default_lod_bias = 1.0f;
+static const float explore_rate = 0.05f; //Fraction of the distance to the surface flown per frame
+static const float explore_min_speed = 1.0f / 16.0f;
+static const float explore_max_speed = 8.0f;
+static const float deep_ref_dist = 0.1f; //Distance to the surface where the explorer starts zooming
+static const float deep_min_scale = 1e-8f; //About the limit of double-float positions
+static const int max_deep_iters = 32;
+static const float default_march_max = 1000.0f;
+static const float default_march_min_dist = 1e-5f;
+static const float default_shadow_sharpness = 10.0f;
+
+//Everything Write sends to the shader, in UniformBlock order
+enum SceneUniforms {
+  U_MAT,
+  U_MARBLE_POS,
+  U_MARBLE_RAD,
+  U_FLAG_SCALE,
+  U_FLAG_POS,
+  U_FRAC_SCALE,
+  U_FRAC_ANG1,
+  U_FRAC_ANG2,
+  U_FRAC_ROT,
+  U_FRAC_SHIFT,
+  U_FRAC_COL,
+  U_FRAC_BOUND,
+  U_MARCH_OMEGA,
+  U_LOD_BIAS,
+  U_MAX_MARCHES,
+  U_MIN_DIST,
+  U_SHADOW_SHARPNESS,
+  U_EXPOSURE,
+  U_ORIGIN,
+  U_ORIGIN_LOW,
+  U_DEEP_ZOOM,
+  U_DEEP_ITERS,
+  NUM_SCENE_UNIFORMS
+};
+static const UniformBlock::Layout scene_uniforms[NUM_SCENE_UNIFORMS] = {
+  { "iMat", 16 },
+  { "iMarblePos", 3 },
+  { "iMarbleRad", 1 },
+  { "iFlagScale", 1 },
+  { "iFlagPos", 3 },
+  { "iFracScale", 1 },
+  { "iFracAng1", 1 },
+  { "iFracAng2", 1 },
+  { "iFracRot", 4 },
+  { "iFracShift", 3 },
+  { "iFracCol", 3 },
+  { "iFracBound", 1 },
+  { "iMarchOmega", 1 },
+  { "iLODBias", 1 },
+  { "iMaxMarches", 1 },
+  { "iMinDist", 1 },
+  { "iShadowSharpness", 1 },
+  { "iExposure", 1 },
+  { "iOrigin", 3 },
+  { "iOriginLow", 3 },
+  { "iDeepZoom", 1 },
+  { "iDeepIters", 1 },
+};
 
 static void ModPi(float& a, float b) {
   if (a - b > pi) {
@@ -55,11 +118,20 @@ Scene::Scene(sf::Music* m1, sf::Music* m2) :
   intro_needs_snap(true),
   play_single(false),
   exposure(1.0f),
+  lod_bias(default_lod_bias),
+  explore_pos(0.0, 0.0, 0.0),
+  explore_speed(1.0f),
+  deep_scale(1.0f),
+  march_max(default_march_max),
+  march_min_dist(default_march_min_dist),
+  shadow_sharpness(default_shadow_sharpness),
+  uniforms(CreateUniforms()),
   camera(Camera()),
   marble(Marble()),
   flag_pos(0.0f, 0.0f, 0.0f),
   timer(0),
   final_time(0),
+  explored(false),
   music_1(m1),
   music_2(m2),
   cur_level(0) {
@@ -93,18 +165,37 @@ void Scene::SetMarble(float x, float y, float z, float r) {
   marble.SetVelocity(marble.GetVelocity().setZero());
 }
 
+void Scene::SetMarchLimits(float max_marches, float min_dist, float sharpness) {
+  march_max = max_marches;
+  march_min_dist = min_dist;
+  shadow_sharpness = sharpness;
+}
+
 void Scene::SetFlagPosition(float x, float y, float z) {
   flag_pos = Eigen::Vector3f(x, y, z);
 }
 
 void Scene::SetMode(Camera::CamMode mode) {
-  //Don't reset the timer if transitioning to screen saver
+  //Don't reset the timer if transitioning to screen saver or pausing to explore
   if ((camera.GetMode() == Camera::INTRO && mode == Camera::SCREEN_SAVER) ||
-      (camera.GetMode() == Camera::SCREEN_SAVER && mode == Camera::INTRO)) {
+      (camera.GetMode() == Camera::SCREEN_SAVER && mode == Camera::INTRO) ||
+      camera.GetMode() == Camera::EXPLORE || mode == Camera::EXPLORE) {
   } else {
     timer = 0;
     intro_needs_snap = true;
   }
+  if (mode == Camera::DEORBIT) {
+    //Every attempt at a level starts with a deorbit
+    explored = false;
+  }
+  if (mode == Camera::EXPLORE) {
+    //Scouting the route with the clock stopped doesn't count towards a high score
+    explored = true;
+    //Take off from wherever the camera is
+    explore_pos = camera.GetPosition().cast<double>();
+    explore_speed = 1.0f;
+    deep_scale = 1.0f;
+  }
   camera.SetMode(mode);
 }
 
@@ -140,7 +231,7 @@ void Scene::StopAllMusic() {
 }
 
 bool Scene::IsHighScore() const {
-  if (camera.GetMode() != Camera::GOAL) {
+  if (camera.GetMode() != Camera::GOAL || explored) {
     return false;
   } else {
     return final_time == high_scores.Get(cur_level);
@@ -432,6 +523,52 @@ void Scene::UpdateNormal(float dx, float dy, float dz) {
   timer += 1;
 }
 
+void Scene::UpdateExplore(float dx, float dy, float dz, float move_lr, float move_fb) {
+  //Ignore other modes
+  if (camera.GetMode() != Camera::EXPLORE) {
+    return;
+  }
+
+  //Look around without smoothing, the flight already slows down near the surface
+  camera.SetLookX(camera.GetLookX() + dx);
+  camera.SetLookY(std::min(std::max(camera.GetLookY() + dy, -pi/2), pi/2));
+  while (camera.GetLookX() > pi) { camera.SetLookX(camera.GetLookX() - 2*pi); }
+  while (camera.GetLookX() < -pi) { camera.SetLookX(camera.GetLookX() + 2*pi); }
+  camera.SetLookXSmooth(camera.GetLookX());
+  camera.SetLookYSmooth(camera.GetLookY());
+  MakeCameraRotation();
+
+  //The wheel sets the speed relative to the distance to the surface
+  explore_speed *= std::pow(2.0f, dz);
+  explore_speed = std::min(std::max(explore_speed, explore_min_speed), explore_max_speed);
+
+  //Steps are a fraction of the distance to the surface, so the camera can't pass through it,
+  //and moves that end closer than double precision can resolve are dropped
+  const int iters = fractal_iters + DeepIters(deep_scale, frac_params_smooth[0]);
+  const double min_dist = double(deep_ref_dist) * double(deep_min_scale);
+  double d = DE(explore_pos, iters);
+  const Eigen::Vector3f move = camera.GetMatrix().block<3, 3>(0, 0) * Eigen::Vector3f(move_lr, 0.0f, -move_fb);
+  if (move.squaredNorm() > 0.0f) {
+    const double step = std::abs(d) * double(explore_rate * explore_speed);
+    const Eigen::Vector3d next = explore_pos + move.cast<double>().normalized() * step;
+    const double next_d = DE(next, iters);
+    if (d <= 0.0 || next_d >= min_dist) {
+      explore_pos = next;
+      d = next_d;
+    }
+  }
+
+  //Zoom in as the surface gets closer than the game's camera ever gets
+  deep_scale = float(std::min(std::max(std::abs(d) / double(deep_ref_dist), double(deep_min_scale)), 1.0));
+
+  //Update the camera matrix
+  camera.SetPosition(explore_pos.cast<float>());
+  camera.SetPositionSmooth(camera.GetPosition());
+  Eigen::Matrix4f cam_mat = camera.GetMatrix();
+  cam_mat.block<3, 1>(0, 3) = camera.GetPosition();
+  camera.SetMatrix(cam_mat);
+}
+
 void Scene::UpdateGoal() {
   //Update the timer
   const float t = timer * 0.01f;
@@ -497,21 +634,58 @@ void Scene::HideObjects() {
 }
 
 void Scene::Write(sf::Shader& shader) const {
-  shader.setUniform("iMat", sf::Glsl::Mat4(camera.GetMatrix().data()));
-
-  shader.setUniform("iMarblePos", sf::Glsl::Vec3(marble.GetPosition().x(), marble.GetPosition().y(), marble.GetPosition().z()));
-  shader.setUniform("iMarbleRad", marble.GetRadius());
+  //Only values that changed since the last frame reach the shader
+  UpdateUniforms();
+  uniforms.Upload(shader);
+}
 
-  shader.setUniform("iFlagScale", all_levels[cur_level].planet ? -marble.GetRadius() : marble.GetRadius());
-  shader.setUniform("iFlagPos", sf::Glsl::Vec3(flag_pos.x(), flag_pos.y(), flag_pos.z()));
+std::vector<float> Scene::GetViewState() const {
+  UpdateUniforms();
+  return uniforms.GetValues();
+}
 
-  shader.setUniform("iFracScale", frac_params_smooth[0]);
-  shader.setUniform("iFracAng1", frac_params_smooth[1]);
-  shader.setUniform("iFracAng2", frac_params_smooth[2]);
-  shader.setUniform("iFracShift", sf::Glsl::Vec3(frac_params_smooth[3], frac_params_smooth[4], frac_params_smooth[5]));
-  shader.setUniform("iFracCol", sf::Glsl::Vec3(frac_params_smooth[6], frac_params_smooth[7], frac_params_smooth[8]));
+UniformBlock Scene::CreateUniforms() {
+  return UniformBlock(scene_uniforms, NUM_SCENE_UNIFORMS);
+}
 
-  shader.setUniform("iExposure", exposure);
+void Scene::UpdateUniforms() const {
+  //While exploring, positions are sent relative to the camera, whose own position
+  //is split into a float and the rest for the shader's double-float folds
+  const bool deep = (camera.GetMode() == Camera::EXPLORE);
+  const Eigen::Vector3d origin = (deep ? explore_pos : Eigen::Vector3d::Zero());
+  const Eigen::Vector3f origin_hi = origin.cast<float>();
+  const Eigen::Vector3f origin_lo = (origin - origin_hi.cast<double>()).cast<float>();
+  Eigen::Matrix4f cam_mat = camera.GetMatrix();
+  cam_mat.block<3, 1>(0, 3) = (cam_mat.block<3, 1>(0, 3).cast<double>() - origin).cast<float>();
+  uniforms.Set(U_MAT, cam_mat.data());
+  uniforms.Set(U_ORIGIN, origin_hi.x(), origin_hi.y(), origin_hi.z());
+  uniforms.Set(U_ORIGIN_LOW, origin_lo.x(), origin_lo.y(), origin_lo.z());
+  uniforms.Set(U_DEEP_ZOOM, deep ? -std::log2(deep_scale) : 0.0f);
+  uniforms.Set(U_DEEP_ITERS, deep ? float(DeepIters(deep_scale, frac_params_smooth[0])) : 0.0f);
+
+  const Eigen::Vector3f marble_pos = (marble.GetPosition().cast<double>() - origin).cast<float>();
+  uniforms.Set(U_MARBLE_POS, marble_pos.x(), marble_pos.y(), marble_pos.z());
+  uniforms.Set(U_MARBLE_RAD, marble.GetRadius());
+
+  const Eigen::Vector3f rel_flag_pos = (flag_pos.cast<double>() - origin).cast<float>();
+  uniforms.Set(U_FLAG_SCALE, all_levels[cur_level].planet ? -marble.GetRadius() : marble.GetRadius());
+  uniforms.Set(U_FLAG_POS, rel_flag_pos.x(), rel_flag_pos.y(), rel_flag_pos.z());
+
+  uniforms.Set(U_FRAC_SCALE, frac_params_smooth[0]);
+  uniforms.Set(U_FRAC_ANG1, frac_params_smooth[1]);
+  uniforms.Set(U_FRAC_ANG2, frac_params_smooth[2]);
+  uniforms.Set(U_FRAC_ROT, std::cos(frac_params_smooth[1]), std::sin(frac_params_smooth[1]),
+                           std::cos(frac_params_smooth[2]), std::sin(frac_params_smooth[2]));
+  uniforms.Set(U_FRAC_SHIFT, frac_params_smooth[3], frac_params_smooth[4], frac_params_smooth[5]);
+  uniforms.Set(U_FRAC_COL, frac_params_smooth[6], frac_params_smooth[7], frac_params_smooth[8]);
+  uniforms.Set(U_FRAC_BOUND, FractalBound());
+  uniforms.Set(U_MARCH_OMEGA, all_levels[cur_level].march_omega);
+  uniforms.Set(U_LOD_BIAS, lod_bias);
+  uniforms.Set(U_MAX_MARCHES, march_max);
+  uniforms.Set(U_MIN_DIST, march_min_dist);
+  uniforms.Set(U_SHADOW_SHARPNESS, shadow_sharpness);
+
+  uniforms.Set(U_EXPOSURE, exposure);
 }
 
 //Hard-coded to match the fractal
@@ -555,6 +729,146 @@ float Scene::DE(const Eigen::Vector3f& pt) const {
   return (std::min(std::max(std::max(a.x(), a.y()), a.z()), 0.0f) + a.cwiseMax(0.0f).norm()) / p.w();
 }
 
+//Same folds as above on a packet of points, for the software renderer
+Scene::Packet Scene::DE(const Packet& px, const Packet& py, const Packet& pz) const {
+  return DE(frac_params_smooth, px, py, pz);
+}
+
+Scene::Packet Scene::DE(const FractalParams& params, const Packet& px, const Packet& py, const Packet& pz) {
+  const float frac_scale = params[0];
+  const float rotz_c = std::cos(params[1]);
+  const float rotz_s = std::sin(params[1]);
+  const float rotx_c = std::cos(params[2]);
+  const float rotx_s = std::sin(params[2]);
+  const Eigen::Vector3f frac_shift = params.segment<3>(3);
+
+  Packet x = px, y = py, z = pz;
+  float w = 1.0f;
+  for (int i = 0; i < fractal_iters; ++i) {
+    //absFold
+    x = x.abs(); y = y.abs(); z = z.abs();
+    //rotZ
+    const Packet rotz_x = rotz_c*x + rotz_s*y;
+    y = rotz_c*y - rotz_s*x;
+    x = rotz_x;
+    //mengerFold
+    Packet a = (x - y).min(0.0f);
+    x -= a; y += a;
+    a = (x - z).min(0.0f);
+    x -= a; z += a;
+    a = (y - z).min(0.0f);
+    y -= a; z += a;
+    //rotX
+    const Packet rotx_y = rotx_c*y + rotx_s*z;
+    z = rotx_c*z - rotx_s*y;
+    y = rotx_y;
+    //scaleTrans
+    x = x*frac_scale + frac_shift.x();
+    y = y*frac_scale + frac_shift.y();
+    z = z*frac_scale + frac_shift.z();
+    w *= frac_scale;
+  }
+  const Packet ax = x.abs() - 6.0f;
+  const Packet ay = y.abs() - 6.0f;
+  const Packet az = z.abs() - 6.0f;
+  const Packet outside = (ax.max(0.0f).square() + ay.max(0.0f).square() + az.max(0.0f).square()).sqrt();
+  return (ax.max(ay).max(az).min(0.0f) + outside) / w;
+}
+
+//Same folds as above in double precision, with the float rotation the shader's deep folds use
+double Scene::DE(const Eigen::Vector3d& pt, int iters) const {
+  const double frac_scale = frac_params_smooth[0];
+  const double rotz_c = std::cos(frac_params_smooth[1]);
+  const double rotz_s = std::sin(frac_params_smooth[1]);
+  const double rotx_c = std::cos(frac_params_smooth[2]);
+  const double rotx_s = std::sin(frac_params_smooth[2]);
+  const Eigen::Vector3d frac_shift = frac_params_smooth.segment<3>(3).cast<double>();
+
+  Eigen::Vector3d p = pt;
+  double w = 1.0;
+  for (int i = 0; i < iters; ++i) {
+    //absFold
+    p = p.cwiseAbs();
+    //rotZ
+    const double rotz_x = rotz_c*p.x() + rotz_s*p.y();
+    p.y() = rotz_c*p.y() - rotz_s*p.x();
+    p.x() = rotz_x;
+    //mengerFold
+    if (p.x() < p.y()) { std::swap(p.x(), p.y()); }
+    if (p.x() < p.z()) { std::swap(p.x(), p.z()); }
+    if (p.y() < p.z()) { std::swap(p.y(), p.z()); }
+    //rotX
+    const double rotx_y = rotx_c*p.y() + rotx_s*p.z();
+    p.z() = rotx_c*p.z() - rotx_s*p.y();
+    p.y() = rotx_y;
+    //scaleTrans
+    p = p*frac_scale + frac_shift;
+    w *= frac_scale;
+  }
+  const Eigen::Vector3d a = p.cwiseAbs() - Eigen::Vector3d(6.0, 6.0, 6.0);
+  return (std::min(std::max(std::max(a.x(), a.y()), a.z()), 0.0) + a.cwiseMax(0.0).norm()) / w;
+}
+
+int Scene::DeepIters(float deep_scale, float frac_scale) {
+  //Each fold magnifies by the scale, so one more per scale of zoom keeps
+  //the float error of the remaining folds below the surface distance
+  if (deep_scale >= 1.0f || frac_scale <= 1.0f) {
+    return 0;
+  }
+  const int iters = int(std::ceil(std::log(1.0f / deep_scale) / std::log(frac_scale)));
+  return std::min(iters, max_deep_iters);
+}
+
+Eigen::Vector3f Scene::FractalColor(const Eigen::Vector3f& pt) const {
+  const float frac_scale = frac_params_smooth[0];
+  const float frac_angle1 = frac_params_smooth[1];
+  const float frac_angle2 = frac_params_smooth[2];
+  const Eigen::Vector3f frac_shift = frac_params_smooth.segment<3>(3);
+  const Eigen::Vector3f frac_color = frac_params_smooth.segment<3>(6);
+
+  Eigen::Vector3f p = pt;
+  Eigen::Vector3f orbit = Eigen::Vector3f::Zero();
+  for (int i = 0; i < fractal_iters; ++i) {
+    p = p.cwiseAbs();
+    const float rotz_x = std::cos(frac_angle1)*p.x() + std::sin(frac_angle1)*p.y();
+    p.y() = std::cos(frac_angle1)*p.y() - std::sin(frac_angle1)*p.x();
+    p.x() = rotz_x;
+    float a = std::min(p.x() - p.y(), 0.0f);
+    p.x() -= a; p.y() += a;
+    a = std::min(p.x() - p.z(), 0.0f);
+    p.x() -= a; p.z() += a;
+    a = std::min(p.y() - p.z(), 0.0f);
+    p.y() -= a; p.z() += a;
+    const float rotx_y = std::cos(frac_angle2)*p.y() + std::sin(frac_angle2)*p.z();
+    p.z() = std::cos(frac_angle2)*p.z() - std::sin(frac_angle2)*p.y();
+    p.y() = rotx_y;
+    p = p*frac_scale + frac_shift;
+    orbit = orbit.cwiseMax(p.cwiseProduct(frac_color));
+  }
+  return orbit;
+}
+
+//Radius around the origin that contains the whole fractal surface.
+//The folds and rotations preserve |p|, so outside r0 = |shift|/(scale-1)
+//every iteration pushes the point further out and it never reaches the box.
+float Scene::FractalBound() const {
+  return FractalBound(frac_params_smooth);
+}
+
+float Scene::FractalBound(const FractalParams& params) {
+  const float frac_scale = params[0];
+  if (frac_scale <= 1.0f) {
+    return bound_none;
+  }
+  const float r0 = params.segment<3>(3).norm() / (frac_scale - 1.0f);
+  const float box_r = 6.0f * std::sqrt(3.0f);
+  return r0 + std::max(box_r - r0, 0.0f) / std::pow(frac_scale, float(fractal_iters)) + bound_margin;
+}
+
+bool Scene::IsFractalStatic() const {
+  return !all_levels[cur_level].IsAnimated() && frac_params_smooth == all_levels[cur_level].params;
+}
+
 //Hard-coded to match the fractal
 Eigen::Vector3f Scene::NP(const Eigen::Vector3f& pt) const {
   //Easier to work with names
@@ -562,16 +876,16 @@ Eigen::Vector3f Scene::NP(const Eigen::Vector3f& pt) const {
   const float frac_angle1 = frac_params_smooth[1];
   const float frac_angle2 = frac_params_smooth[2];
   const Eigen::Vector3f frac_shift = frac_params_smooth.segment<3>(3);
-  const Eigen::Vector3f frac_color = frac_params_smooth.segment<3>(6);
 
-  static std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f>> p_hist;
-  p_hist.clear();
+  //Two folds per iteration, kept local since other threads run their own scenes
+  Eigen::Vector4f p_hist[fractal_iters * 2];
+  int hist_size = 0;
   Eigen::Vector4f p;
   p << pt, 1.0f;
   //Fold the point, keeping history
   for (int i = 0; i < fractal_iters; ++i) {
     //absFold
-    p_hist.push_back(p);
+    p_hist[hist_size++] = p;
     p.segment<3>(0) = p.segment<3>(0).cwiseAbs();
     //rotZ
     const float rotz_c = std::cos(frac_angle1);
@@ -580,7 +894,7 @@ Eigen::Vector3f Scene::NP(const Eigen::Vector3f& pt) const {
     const float rotz_y = rotz_c*p.y() - rotz_s*p.x();
     p.x() = rotz_x; p.y() = rotz_y;
     //mengerFold
-    p_hist.push_back(p);
+    p_hist[hist_size++] = p;
     float a = std::min(p.x() - p.y(), 0.0f);
     p.x() -= a; p.y() += a;
     a = std::min(p.x() - p.z(), 0.0f);
@@ -611,7 +925,7 @@ Eigen::Vector3f Scene::NP(const Eigen::Vector3f& pt) const {
     const float rotx_z = rotx_c*n.z() - rotx_s*n.y();
     n.y() = rotx_y; n.z() = rotx_z;
     //mengerUnfold
-    p = p_hist.back(); p_hist.pop_back();
+    p = p_hist[--hist_size];
     const float mx = std::max(p[0], p[1]);
     if (std::min(p[0], p[1]) < std::min(mx, p[2])) {
       std::swap(n[1], n[2]);
@@ -629,7 +943,7 @@ Eigen::Vector3f Scene::NP(const Eigen::Vector3f& pt) const {
     const float rotz_y = rotz_c*n.y() - rotz_s*n.x();
     n.x() = rotz_x; n.y() = rotz_y;
     //absUnfold
-    p = p_hist.back(); p_hist.pop_back();
+    p = p_hist[--hist_size];
     if (p[0] < 0.0f) {
       n[0] = -n[0];
     }
@@ -643,6 +957,102 @@ Eigen::Vector3f Scene::NP(const Eigen::Vector3f& pt) const {
   return n;
 }
 
+//Hard-coded to match the fractal, gives the gradient direction of DE
+Eigen::Vector3f Scene::DENormal(const Eigen::Vector3f& pt) const {
+  //Easier to work with names
+  const float frac_scale = frac_params_smooth[0];
+  const float frac_angle1 = frac_params_smooth[1];
+  const float frac_angle2 = frac_params_smooth[2];
+  const Eigen::Vector3f frac_shift = frac_params_smooth.segment<3>(3);
+
+  //Two folds per iteration, kept local since other threads run their own scenes
+  Eigen::Vector4f p_hist[fractal_iters * 2];
+  int hist_size = 0;
+  Eigen::Vector4f p;
+  p << pt, 1.0f;
+  //Fold the point, keeping history
+  for (int i = 0; i < fractal_iters; ++i) {
+    //absFold
+    p_hist[hist_size++] = p;
+    p.segment<3>(0) = p.segment<3>(0).cwiseAbs();
+    //rotZ
+    const float rotz_c = std::cos(frac_angle1);
+    const float rotz_s = std::sin(frac_angle1);
+    const float rotz_x = rotz_c*p.x() + rotz_s*p.y();
+    const float rotz_y = rotz_c*p.y() - rotz_s*p.x();
+    p.x() = rotz_x; p.y() = rotz_y;
+    //mengerFold
+    p_hist[hist_size++] = p;
+    float a = std::min(p.x() - p.y(), 0.0f);
+    p.x() -= a; p.y() += a;
+    a = std::min(p.x() - p.z(), 0.0f);
+    p.x() -= a; p.z() += a;
+    a = std::min(p.y() - p.z(), 0.0f);
+    p.y() -= a; p.z() += a;
+    //rotX
+    const float rotx_c = std::cos(frac_angle2);
+    const float rotx_s = std::sin(frac_angle2);
+    const float rotx_y = rotx_c*p.y() + rotx_s*p.z();
+    const float rotx_z = rotx_c*p.z() - rotx_s*p.y();
+    p.y() = rotx_y; p.z() = rotx_z;
+    //scaleTrans
+    p *= frac_scale;
+    p.segment<3>(0) += frac_shift;
+  }
+  //Get the gradient of the box
+  const Eigen::Vector3f a = p.segment<3>(0).cwiseAbs() - Eigen::Vector3f(6.0f, 6.0f, 6.0f);
+  Eigen::Vector3f n = a.cwiseMax(0.0f);
+  if (a.maxCoeff() <= 0.0f) {
+    int ix;
+    a.maxCoeff(&ix);
+    n[ix] = 1.0f;
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (p[i] < 0.0f) {
+      n[i] = -n[i];
+    }
+  }
+  //Then unfold the gradient (reverse order), scale and shift don't turn it
+  for (int i = 0; i < fractal_iters; ++i) {
+    //rotX
+    const float rotx_c = std::cos(-frac_angle2);
+    const float rotx_s = std::sin(-frac_angle2);
+    const float rotx_y = rotx_c*n.y() + rotx_s*n.z();
+    const float rotx_z = rotx_c*n.z() - rotx_s*n.y();
+    n.y() = rotx_y; n.z() = rotx_z;
+    //mengerUnfold
+    p = p_hist[--hist_size];
+    const float mx = std::max(p[0], p[1]);
+    if (std::min(p[0], p[1]) < std::min(mx, p[2])) {
+      std::swap(n[1], n[2]);
+    }
+    if (mx < p[2]) {
+      std::swap(n[0], n[2]);
+    }
+    if (p[0] < p[1]) {
+      std::swap(n[0], n[1]);
+    }
+    //rotZ
+    const float rotz_c = std::cos(-frac_angle1);
+    const float rotz_s = std::sin(-frac_angle1);
+    const float rotz_x = rotz_c*n.x() + rotz_s*n.y();
+    const float rotz_y = rotz_c*n.y() - rotz_s*n.x();
+    n.x() = rotz_x; n.y() = rotz_y;
+    //absUnfold
+    p = p_hist[--hist_size];
+    if (p[0] < 0.0f) {
+      n[0] = -n[0];
+    }
+    if (p[1] < 0.0f) {
+      n[1] = -n[1];
+    }
+    if (p[2] < 0.0f) {
+      n[2] = -n[2];
+    }
+  }
+  return n.normalized();
+}
+
 bool Scene::MarbleCollision(float& delta_v) {
   //Check if the distance estimate indicates a collision
   const float de = DE(marble.GetPosition());
@@ -683,7 +1093,9 @@ void Scene::CheckIfMarbleHasHitFlag()
 			const float fz = marble.GetPosition().z() - flag_pos.z();
 			if (fx*fx + fz * fz < 6 * marble.GetRadius()*marble.GetRadius()) {
 				final_time = timer;
-				high_scores.Update(cur_level, final_time);
+				if (!explored) {
+					high_scores.Update(cur_level, final_time);
+				}
 				SetMode(Camera::GOAL);
 				sound_goal.play();
 			}
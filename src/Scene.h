@@ -18,13 +18,17 @@
 #include "Level.h"
 #include "Marble.h"
 #include "Camera.h"
+#include "UniformBlock.h"
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
 #include <Eigen/Dense>
+#include <vector>
 
 class Scene {
 public:
-  
+  //Eight lanes evaluated together, sized to fill an AVX register
+  typedef Eigen::Array<float, 8, 1> Packet;
+
   Scene(sf::Music* m1, sf::Music* m2);
 
   void LoadLevel(int level);
@@ -32,9 +36,14 @@ public:
   void SetFlagPosition(float x, float y, float z);
   void SetMode(Camera::CamMode mode);
   void SetExposure(float e) { exposure = e; }
+  void SetLODBias(float b) { lod_bias = b; }
+  //Never finer than the quality preset, the shader keeps its own defines as the limit
+  void SetMarchLimits(float max_marches, float min_dist, float shadow_sharpness);
   void SetTimer(int t) { timer = t; }
   void SetSinglePlay(bool b) { play_single = b; }
   void SetLevel(int level) { cur_level = level; }
+  //Back to a new camera, so a reused scene frames its shots like a new scene
+  void ResetCamera() { camera = Camera(); }
 
   const Marble GetMarble() const { return marble; }
   Eigen::Vector3f GetFlagPosition() const { return flag_pos; }
@@ -46,6 +55,7 @@ public:
   int GetCountdownTime() const;
   sf::Vector3f GetGoalDirection() const;
   float GetExposure() { return exposure; }
+  float GetLODBias() const { return lod_bias; }
   bool IsSinglePlay() const { return play_single; }
   bool IsHighScore() const;
   int GetCurLevel() const { return cur_level; }
@@ -61,14 +71,38 @@ public:
 
   void UpdateMarble(float dx=0.0f, float dy=0.0f);
   void UpdateCamera(float dx=0.0f, float dy=0.0f, float dz=0.0f);
+  //Free flight from where the camera was while the marble waits, slower near the surface
+  void UpdateExplore(float dx, float dy, float dz, float move_lr, float move_fb);
 
   void SnapCamera();
   void HideObjects();
 
   void Write(sf::Shader& shader) const;
+  std::vector<float> GetViewState() const;
+  const UniformBlock& GetUniforms() const { UpdateUniforms(); return uniforms; }
+  void InvalidateUniforms() { uniforms.Invalidate(); }
+  //An empty block with the layout Write uses, for loading saved views
+  static UniformBlock CreateUniforms();
 
   float DE(const Eigen::Vector3f& pt) const;
+  Packet DE(const Packet& x, const Packet& y, const Packet& z) const;
+  static Packet DE(const FractalParams& params, const Packet& x, const Packet& y, const Packet& z);
+  //Double precision with a given number of folds, for collisions while exploring
+  double DE(const Eigen::Vector3d& pt, int iters) const;
+  //Folds run in double-float at a zoom, matches deep_folds in frag.glsl
+  static int DeepIters(float deep_scale, float frac_scale);
+  //Below 1 while exploring closer to the surface than the game's camera gets
+  float GetDeepScale() const { return deep_scale; }
+  //The fractal as the shader currently sees it
+  const FractalParams& GetFractalParams() const { return frac_params_smooth; }
+  //Orbit trap color, matches col_fractal in frag.glsl
+  Eigen::Vector3f FractalColor(const Eigen::Vector3f& pt) const;
+  float FractalBound() const;
+  static float FractalBound(const FractalParams& params);
+  //True while the fractal is exactly the current level's and not animating
+  bool IsFractalStatic() const;
   Eigen::Vector3f NP(const Eigen::Vector3f& pt) const;
+  Eigen::Vector3f DENormal(const Eigen::Vector3f& pt) const;
   bool MarbleCollision(float& delta_v);
 
   void CheckIfMarbleHasHitFlag();
@@ -86,6 +120,7 @@ protected:
   void UpdateNormal(float dx, float dy, float dz);
   void UpdateGoal();
   void MakeCameraRotation();
+  void UpdateUniforms() const;
 
 private:
   int             cur_level;
@@ -103,7 +138,16 @@ private:
 
   int             timer;
   int             final_time;
+  bool            explored;
   float           exposure;
+  float           lod_bias;
+  Eigen::Vector3d explore_pos;
+  float           explore_speed;
+  float           deep_scale;
+  float           march_max;
+  float           march_min_dist;
+  float           shadow_sharpness;
+  mutable UniformBlock uniforms;
 
   sf::Sound sound_goal;
   sf::SoundBuffer buff_goal;
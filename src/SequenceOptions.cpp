@@ -0,0 +1,151 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SequenceOptions.h"
+#include <cstdio>
+#include <cstdlib>
+
+static bool ParseInt(const char* str, int min_value, int& value) {
+  char* end = nullptr;
+  const long v = std::strtol(str, &end, 10);
+  if (end == str || *end != 0 || v < min_value || v > 1000000) {
+    return false;
+  }
+  value = int(v);
+  return true;
+}
+
+SequenceOptions::SequenceOptions() :
+  requested(false),
+  path(SCREEN_SAVER),
+  level(1),
+  frames(600),
+  skip(0),
+  step(1),
+  width(1920),
+  height(1080),
+  supersample(1),
+  format(FrameCapture::PNG),
+  quality("ultra"),
+  listen_port(0),
+  tile_size(128),
+  worker(false),
+  worker_port(0) {
+}
+
+bool SequenceOptions::Parse(int argc, char* argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--render-sequence") {
+      requested = true;
+      continue;
+    } else if (arg.compare(0, 2, "--") != 0) {
+      if (!out_dir.empty()) { return false; }
+      out_dir = arg;
+      continue;
+    }
+
+    //Everything else takes a value
+    if (i + 1 >= argc) { return false; }
+    const char* value = argv[++i];
+    if (arg == "--path") {
+      const std::string p = value;
+      if (p == "screensaver") {
+        path = SCREEN_SAVER;
+      } else if (p == "orbit") {
+        path = ORBIT;
+      } else {
+        return false;
+      }
+    } else if (arg == "--level") {
+      if (!ParseInt(value, 1, level)) { return false; }
+    } else if (arg == "--frames") {
+      if (!ParseInt(value, 1, frames)) { return false; }
+    } else if (arg == "--skip") {
+      if (!ParseInt(value, 0, skip)) { return false; }
+    } else if (arg == "--step") {
+      if (!ParseInt(value, 1, step)) { return false; }
+    } else if (arg == "--size") {
+      unsigned int w = 0, h = 0;
+      char extra = 0;
+      if (std::sscanf(value, "%ux%u%c", &w, &h, &extra) != 2 || w == 0 || h == 0) { return false; }
+      width = w;
+      height = h;
+    } else if (arg == "--supersample") {
+      if (!ParseInt(value, 1, supersample) || supersample > 8) { return false; }
+    } else if (arg == "--format") {
+      const std::string f = value;
+      if (f == "png") {
+        format = FrameCapture::PNG;
+      } else if (f == "qoi") {
+        format = FrameCapture::QOI;
+      } else {
+        return false;
+      }
+    } else if (arg == "--quality") {
+      quality = value;
+    } else if (arg == "--listen") {
+      int port = 0;
+      if (!ParseInt(value, 1, port) || port > 65535) { return false; }
+      listen_port = (unsigned short)port;
+    } else if (arg == "--tile") {
+      int size = 0;
+      if (!ParseInt(value, 8, size)) { return false; }
+      tile_size = (unsigned int)size;
+    } else if (arg == "--render-worker") {
+      const std::string address = value;
+      const size_t colon = address.rfind(':');
+      int port = 0;
+      if (colon == std::string::npos || colon == 0 || !ParseInt(address.c_str() + colon + 1, 1, port) || port > 65535) {
+        return false;
+      }
+      worker = true;
+      worker_host = address.substr(0, colon);
+      worker_port = (unsigned short)port;
+    } else {
+      return false;
+    }
+  }
+  if (requested && out_dir.empty()) {
+    out_dir = ".";
+  }
+  return true;
+}
+
+std::string SequenceOptions::FrameName(int frame) const {
+  char num[16];
+  std::snprintf(num, sizeof(num), "%05d", frame);
+  return out_dir + "/frame_" + num + (format == FrameCapture::QOI ? ".qoi" : ".png");
+}
+
+const char* SequenceOptions::Usage() {
+  return
+    "Usage: MarbleMarcher --render-sequence [out_dir] [options]\n"
+    "  --path screensaver|orbit  camera path (screensaver)\n"
+    "  --level N                 level for the orbit path (1)\n"
+    "  --frames N                images to write (600)\n"
+    "  --skip N                  images to skip before the first one (0)\n"
+    "  --step N                  60Hz camera ticks per image (1)\n"
+    "  --size WxH                output resolution (1920x1080)\n"
+    "  --supersample N           render N*N samples per pixel (1)\n"
+    "  --format png|qoi          image format (png)\n"
+    "  --quality NAME            quality preset (ultra)\n"
+    "  --listen PORT             hand tiles to workers instead of rendering\n"
+    "  --tile N                  tile size for workers (128)\n"
+    "\n"
+    "Usage: MarbleMarcher --render-worker HOST:PORT\n"
+    "  Renders tiles for a coordinator started with --listen\n";
+}
@@ -0,0 +1,55 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "FrameCapture.h"
+#include <string>
+
+//Command line settings for rendering a camera path to numbered images
+struct SequenceOptions {
+  enum Path {
+    SCREEN_SAVER,
+    ORBIT
+  };
+
+  SequenceOptions();
+
+  //False if the arguments are malformed, requested is only set by --render-sequence
+  //and worker by --render-worker
+  bool Parse(int argc, char* argv[]);
+  std::string FrameName(int frame) const;
+  static const char* Usage();
+
+  bool requested;
+  std::string out_dir;
+  Path path;
+  int level;
+  int frames;
+  int skip;
+  int step;
+  unsigned int width;
+  unsigned int height;
+  int supersample;
+  FrameCapture::Format format;
+  std::string quality;
+
+  //Distributed rendering, the coordinator listens and workers connect to it
+  unsigned short listen_port;
+  unsigned int tile_size;
+  bool worker;
+  std::string worker_host;
+  unsigned short worker_port;
+};
@@ -0,0 +1,253 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "SequenceRenderer.h"
+#include "FileUtil.h"
+#include "FrameCapture.h"
+#include "Level.h"
+#include "Renderer.h"
+#include "RenderWorker.h"
+#include "Res.h"
+#include "Scene.h"
+#include "ShaderVariants.h"
+#include "TileScheduler.h"
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+static const int progress_period = 60;
+//Tiles sent to a worker before it returns any
+static const int tiles_per_worker = 3;
+//Frames whose tiles may be in flight at once
+static const int frames_ahead = 4;
+
+SequenceRenderer::SequenceRenderer(const SequenceOptions& options) :
+  opts(options) {
+}
+
+int SequenceRenderer::Run() {
+  if (opts.path == SequenceOptions::ORBIT && opts.level > num_levels) {
+    std::cerr << "Level must be between 1 and " << num_levels << std::endl;
+    return 1;
+  }
+  if (!FileUtil::CreateDir(opts.out_dir)) {
+    std::cerr << "Failed to create " << opts.out_dir << std::endl;
+    return 1;
+  }
+
+  //The music is never played, the scene only needs somewhere to point
+  sf::Music music_1;
+  sf::Music music_2;
+  Scene scene(&music_1, &music_2);
+  if (opts.path == SequenceOptions::ORBIT) {
+    scene.StartSingle(opts.level - 1);
+  } else {
+    scene.SetMode(Camera::SCREEN_SAVER);
+  }
+  for (int i = 0; i < opts.skip * opts.step; ++i) {
+    scene.UpdateCamera();
+  }
+  return (opts.listen_port > 0 ? RenderDistributed(scene) : RenderLocal(scene));
+}
+
+int SequenceRenderer::RenderLocal(Scene& scene) {
+  //Everything is drawn offscreen, so no window or display size is involved
+  const unsigned int ss = (unsigned int)opts.supersample;
+  sf::RenderTexture target;
+  if (!sf::Shader::isAvailable() || !target.create(opts.width * ss, opts.height * ss)) {
+    std::cerr << "Failed to create a " << opts.width * ss << "x" << opts.height * ss << " render target" << std::endl;
+    return 1;
+  }
+  target.setActive(true);
+
+  ShaderVariants shader_variants;
+  if (!shader_variants.Load(vert_glsl, frag_glsl, presets_txt)) {
+    std::cerr << "Unable to load shaders" << std::endl;
+    return 1;
+  }
+  const int quality = shader_variants.Find(opts.quality);
+  sf::Shader* shader = (quality >= 0 ? shader_variants.Get(quality) : nullptr);
+  if (!shader) {
+    std::cerr << "Failed to compile quality preset " << opts.quality << std::endl;
+    return 1;
+  }
+
+  Renderer renderer;
+  FrameCapture capture;
+  capture.Init();
+  capture.SetBlocking(true);
+
+  const sf::Vector2f size(float(opts.width * ss), float(opts.height * ss));
+  sf::Clock clock;
+  for (int frame = 0; frame < opts.frames; ++frame) {
+    //Camera paths advance one tick per 60th of a second regardless of render speed
+    for (int i = 0; i < opts.step; ++i) {
+      scene.UpdateCamera();
+    }
+    scene.Write(*shader);
+    renderer.SetViewState(scene.GetViewState());
+    renderer.Draw(target, *shader, size);
+    target.display();
+
+    //Readback and encoding overlap with the next frames
+    capture.Capture(target, opts.FrameName(frame), opts.format, opts.supersample);
+    capture.Update();
+
+    if ((frame + 1) % progress_period == 0) {
+      const float secs = clock.getElapsedTime().asSeconds();
+      std::cout << (frame + 1) << "/" << opts.frames << " frames, " << float(frame + 1) / secs << " fps" << std::endl;
+    }
+  }
+  capture.Flush();
+
+  const float secs = clock.getElapsedTime().asSeconds();
+  std::cout << "Rendered " << opts.frames << " frames in " << secs << "s (" <<
+    float(opts.frames) / secs << " fps) to " << opts.out_dir << std::endl;
+  return 0;
+}
+
+int SequenceRenderer::RenderDistributed(Scene& scene) {
+  sf::TcpListener listener;
+  if (listener.listen(opts.listen_port) != sf::Socket::Done) {
+    std::cerr << "Failed to listen on port " << opts.listen_port << std::endl;
+    return 1;
+  }
+  std::cout << "Waiting for workers on port " << opts.listen_port << std::endl;
+  sf::SocketSelector selector;
+  selector.add(listener);
+
+  //Sockets stay at their index so it can be the scheduler's worker id
+  std::vector<std::unique_ptr<sf::TcpSocket>> workers;
+  std::vector<bool> ready;
+  TileScheduler scheduler(tiles_per_worker);
+  FrameCapture capture;
+  capture.SetBlocking(true);
+
+  //Frames are assembled as tiles arrive and saved as soon as they are complete
+  std::map<int, std::vector<unsigned char>> frame_pixels;
+  std::map<int, std::string> frame_uniforms;
+  int next_frame = 0;
+  int frames_done = 0;
+  sf::Clock clock;
+  while (frames_done < opts.frames) {
+    while (next_frame < opts.frames && int(frame_pixels.size()) < frames_ahead) {
+      for (int i = 0; i < opts.step; ++i) {
+        scene.UpdateCamera();
+      }
+      std::ostringstream uniforms_out;
+      scene.GetUniforms().Save(uniforms_out);
+      frame_uniforms[next_frame] = uniforms_out.str();
+      frame_pixels[next_frame].resize(size_t(opts.width) * size_t(opts.height) * 4);
+      scheduler.AddFrame(next_frame, opts.width, opts.height, opts.tile_size);
+      next_frame += 1;
+    }
+
+    //Keep every worker a few tiles ahead so it never waits on the network
+    for (size_t w = 0; w < workers.size(); ++w) {
+      int tile_id = -1;
+      while (workers[w] && ready[w] && (tile_id = scheduler.Assign(int(w))) >= 0) {
+        const Tile& tile = scheduler.GetTile(tile_id);
+        sf::Packet packet;
+        packet << sf::Uint8(MSG_TILE) << sf::Int32(tile_id) << sf::Uint32(opts.width) << sf::Uint32(opts.height) <<
+          sf::Uint32(tile.x) << sf::Uint32(tile.y) << sf::Uint32(tile.w) << sf::Uint32(tile.h) <<
+          sf::Uint8(opts.supersample) << opts.quality << frame_uniforms[tile.frame];
+        workers[w]->send(packet);
+      }
+    }
+
+    if (!selector.wait(sf::seconds(1.0f))) {
+      continue;
+    }
+    if (selector.isReady(listener)) {
+      std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket);
+      if (listener.accept(*socket) == sf::Socket::Done) {
+        std::cout << "Worker " << workers.size() << " connected from " << socket->getRemoteAddress().toString() << std::endl;
+        selector.add(*socket);
+        workers.push_back(std::move(socket));
+        ready.push_back(false);
+      }
+    }
+    for (size_t w = 0; w < workers.size(); ++w) {
+      if (!workers[w] || !selector.isReady(*workers[w])) {
+        continue;
+      }
+      sf::Packet packet;
+      sf::Uint8 type = 0;
+      if (workers[w]->receive(packet) != sf::Socket::Done || !(packet >> type)) {
+        std::cout << "Worker " << w << " disconnected" << std::endl;
+        scheduler.RemoveWorker(int(w));
+        selector.remove(*workers[w]);
+        workers[w].reset();
+        continue;
+      }
+
+      if (type == MSG_HELLO) {
+        sf::Uint32 version = 0;
+        packet >> version;
+        if (version != render_protocol) {
+          std::cerr << "Worker " << w << " has protocol " << version << ", expected " << render_protocol << std::endl;
+          selector.remove(*workers[w]);
+          workers[w].reset();
+          continue;
+        }
+        ready[w] = true;
+      } else if (type == MSG_RESULT) {
+        sf::Int32 tile_id = -1;
+        std::string pixels;
+        packet >> tile_id >> pixels;
+        if (!packet || tile_id < 0 || tile_id >= scheduler.NumTiles()) {
+          continue;
+        }
+        const Tile tile = scheduler.GetTile(tile_id);
+        if (pixels.size() != size_t(tile.w) * size_t(tile.h) * 4 || !scheduler.Complete(int(w), tile_id)) {
+          continue;
+        }
+        std::vector<unsigned char>& dst = frame_pixels[tile.frame];
+        for (unsigned int row = 0; row < tile.h; ++row) {
+          std::copy(pixels.begin() + size_t(row) * tile.w * 4, pixels.begin() + size_t(row + 1) * tile.w * 4,
+                    dst.begin() + (size_t(tile.y + row) * opts.width + tile.x) * 4);
+        }
+        if (scheduler.IsFrameDone(tile.frame)) {
+          capture.Save(dst, opts.width, opts.height, opts.FrameName(tile.frame), opts.format);
+          frame_pixels.erase(tile.frame);
+          frame_uniforms.erase(tile.frame);
+          frames_done += 1;
+          const float secs = clock.getElapsedTime().asSeconds();
+          std::cout << frames_done << "/" << opts.frames << " frames, " << float(frames_done) / secs << " fps" << std::endl;
+        }
+      }
+    }
+  }
+
+  sf::Packet quit;
+  quit << sf::Uint8(MSG_QUIT);
+  for (size_t w = 0; w < workers.size(); ++w) {
+    if (workers[w]) {
+      workers[w]->send(quit);
+    }
+  }
+  capture.Flush();
+
+  const float secs = clock.getElapsedTime().asSeconds();
+  std::cout << "Rendered " << opts.frames << " frames in " << secs << "s (" <<
+    float(opts.frames) / secs << " fps) with " << workers.size() << " workers to " << opts.out_dir << std::endl;
+  return 0;
+}
@@ -0,0 +1,36 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "SequenceOptions.h"
+
+class Scene;
+
+//Renders a camera path offscreen with a fixed timestep, one image per step
+class SequenceRenderer {
+public:
+  SequenceRenderer(const SequenceOptions& options);
+
+  //Exit code for main, 0 once every frame is written
+  int Run();
+
+private:
+  int RenderLocal(Scene& scene);
+  //Splits frames into tiles for the workers connecting on listen_port
+  int RenderDistributed(Scene& scene);
+
+  SequenceOptions opts;
+};
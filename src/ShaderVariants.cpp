@@ -0,0 +1,141 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ShaderVariants.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static bool ReadFile(const char* fname, std::string& str) {
+  std::ifstream fin(fname);
+  if (!fin) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << fin.rdbuf();
+  str = buffer.str();
+  return true;
+}
+
+static size_t FindDefineValue(const std::string& src, const std::string& name) {
+  //Only whole names at the start of a line
+  const std::string key = "#define " + name + " ";
+  size_t start = src.find(key);
+  while (start != std::string::npos && start > 0 && src[start - 1] != '\n') {
+    start = src.find(key, start + 1);
+  }
+  return (start == std::string::npos ? start : start + key.size());
+}
+
+bool ShaderVariants::Load(const char* vert_fname, const char* frag_fname, const char* presets_fname) {
+  std::ifstream fin(presets_fname);
+  if (!fin || !ReadFile(vert_fname, vert_src) || !ReadFile(frag_fname, frag_src)) {
+    return false;
+  }
+  presets = ParsePresets(fin);
+  shaders.clear();
+  shaders.resize(presets.size());
+  return !presets.empty();
+}
+
+int ShaderVariants::Find(const std::string& name) const {
+  for (size_t i = 0; i < presets.size(); ++i) {
+    if (presets[i].name == name) {
+      return int(i);
+    }
+  }
+  return -1;
+}
+
+float ShaderVariants::GetValue(int i, const std::string& define, float fallback) const {
+  std::string value;
+  if (i >= 0 && i < NumPresets()) {
+    for (size_t j = 0; j < presets[i].defines.size(); ++j) {
+      if (presets[i].defines[j].first == define) {
+        value = presets[i].defines[j].second;
+      }
+    }
+  }
+  if (value.empty()) {
+    value = FindDefine(frag_src, define);
+  }
+  char* end = nullptr;
+  const float result = std::strtof(value.c_str(), &end);
+  return (value.empty() || *end != '\0' ? fallback : result);
+}
+
+sf::Shader* ShaderVariants::Get(int i) {
+  if (i < 0 || i >= NumPresets()) {
+    return nullptr;
+  }
+  if (!shaders[i]) {
+    std::string src = frag_src;
+    std::unique_ptr<sf::Shader> shader(new sf::Shader);
+    if (!ApplyPreset(src, presets[i])) {
+      std::cerr << "Quality preset " << presets[i].name << " does not match the shader" << std::endl;
+      return nullptr;
+    } else if (!shader->loadFromMemory(vert_src, src)) {
+      return nullptr;
+    }
+    shaders[i] = std::move(shader);
+  }
+  return shaders[i].get();
+}
+
+std::vector<QualityPreset> ShaderVariants::ParsePresets(std::istream& in) {
+  std::vector<QualityPreset> result;
+  std::string line;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream line_in(line);
+    QualityPreset preset;
+    if (!(line_in >> preset.name)) {
+      continue;
+    }
+    std::string define;
+    while (line_in >> define) {
+      const size_t eq = define.find('=');
+      if (eq == std::string::npos) {
+        continue;
+      }
+      preset.defines.push_back(std::make_pair(define.substr(0, eq), define.substr(eq + 1)));
+    }
+    result.push_back(preset);
+  }
+  return result;
+}
+
+bool ShaderVariants::ApplyPreset(std::string& src, const QualityPreset& preset) {
+  for (size_t i = 0; i < preset.defines.size(); ++i) {
+    const size_t value_start = FindDefineValue(src, preset.defines[i].first);
+    if (value_start == std::string::npos) {
+      return false;
+    }
+    const size_t value_end = src.find_first_of("\r\n", value_start);
+    src.replace(value_start, value_end - value_start, preset.defines[i].second);
+  }
+  return true;
+}
+
+std::string ShaderVariants::FindDefine(const std::string& src, const std::string& name) {
+  const size_t value_start = FindDefineValue(src, name);
+  if (value_start == std::string::npos) {
+    return std::string();
+  }
+  const size_t value_end = src.find_first_of("\r\n", value_start);
+  return src.substr(value_start, value_end == std::string::npos ? std::string::npos : value_end - value_start);
+}
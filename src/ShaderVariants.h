@@ -0,0 +1,56 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct QualityPreset {
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> defines;
+};
+
+//Fragment shader variants with their #defines replaced per quality preset
+class ShaderVariants {
+public:
+  bool Load(const char* vert_fname, const char* frag_fname, const char* presets_fname);
+
+  int NumPresets() const { return int(presets.size()); }
+  const std::string& GetName(int i) const { return presets[i].name; }
+  int Find(const std::string& name) const;
+  //Number a preset compiles a define to, from the preset or else the shader itself
+  float GetValue(int i, const std::string& define, float fallback) const;
+
+  //Compiles the variant on first use, nullptr if it failed
+  sf::Shader* Get(int i);
+
+  //Lines of "name DEFINE=value ...", # starts a comment
+  static std::vector<QualityPreset> ParsePresets(std::istream& in);
+  //False if the source is missing one of the defines
+  static bool ApplyPreset(std::string& src, const QualityPreset& preset);
+  //Text after "#define name " up to the end of the line, empty if there is none
+  static std::string FindDefine(const std::string& src, const std::string& name);
+
+private:
+  std::string vert_src;
+  std::string frag_src;
+  std::vector<QualityPreset> presets;
+  std::vector<std::unique_ptr<sf::Shader>> shaders;
+};
@@ -0,0 +1,217 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ThumbnailCache.h"
+#include "FileUtil.h"
+#include "FragDefines.h"
+#include "FrameCapture.h"
+#include "Scene.h"
+#include <SFML/Audio.hpp>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+static const unsigned int thumbnail_width = 192;
+static const unsigned int thumbnail_height = 108;
+static const int thumbnail_supersample = 2;
+//Ticks into the orbit, where the level has finished fading in
+static const int thumbnail_ticks = 400;
+//Bump by hand when CpuRenderer's code changes so old thumbnails are replaced,
+//its constants from FragDefines.h are already part of the key
+static const sf::Uint32 thumbnail_version = 1;
+
+static void LowerPriority() {
+#if defined(_WIN32)
+  SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+  sched_param param = {};
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+ThumbnailCache::ThumbnailCache() :
+  renderer(1),
+  requested(false),
+  stop(false) {
+  for (int i = 0; i < num_levels; ++i) {
+    states[i] = UNCHECKED;
+    uploaded[i] = false;
+  }
+}
+
+ThumbnailCache::~ThumbnailCache() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stop = true;
+  }
+  cv.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void ThumbnailCache::Start(const std::string& save_dir) {
+  if (thread.joinable()) {
+    return;
+  }
+  dir = save_dir + "/thumbs";
+  thread = std::thread(&ThumbnailCache::Run, this);
+}
+
+void ThumbnailCache::Request() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    requested = true;
+  }
+  cv.notify_all();
+}
+
+void ThumbnailCache::Update() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (int i = 0; i < num_levels; ++i) {
+    if (states[i] == LOADED && !uploaded[i]) {
+      uploaded[i] = textures[i].loadFromImage(images[i]);
+      textures[i].setSmooth(true);
+      images[i] = sf::Image();
+    }
+  }
+}
+
+const sf::Texture* ThumbnailCache::Get(int level) const {
+  return (uploaded[level] ? &textures[level] : nullptr);
+}
+
+sf::Uint32 ThumbnailCache::Key(const Level& level) {
+  //Everything that changes how the orbit shot looks
+  const float header[] = { float(thumbnail_version), float(thumbnail_width), float(thumbnail_height) };
+  sf::Uint32 hash = FileUtil::Hash(header, sizeof(header));
+  const float shading[] = { focal_dist, max_dist, float(max_march_steps), min_dist, shadow_cutoff, shadow_darkness,
+                            shadow_sharpness, specular_highlight, specular_mult, sun_sharpness, sun_size,
+                            vignette_strength, ambient_occlusion_strength };
+  hash = FileUtil::Hash(shading, sizeof(shading), hash);
+  hash = FileUtil::Hash(ambient_occlusion_delta.data(), 3 * sizeof(float), hash);
+  hash = FileUtil::Hash(background_color.data(), 3 * sizeof(float), hash);
+  hash = FileUtil::Hash(light_color.data(), 3 * sizeof(float), hash);
+  hash = FileUtil::Hash(light_dir.data(), 3 * sizeof(float), hash);
+  hash = FileUtil::Hash(level.params.data(), num_fractal_params * sizeof(float), hash);
+  hash = FileUtil::Hash(&level.marble_rad, sizeof(float), hash);
+  hash = FileUtil::Hash(&level.orbit_dist, sizeof(float), hash);
+  hash = FileUtil::Hash(level.start_pos.data(), 3 * sizeof(float), hash);
+  hash = FileUtil::Hash(level.end_pos.data(), 3 * sizeof(float), hash);
+  hash = FileUtil::Hash(&level.march_omega, sizeof(float), hash);
+  const float planet = (level.planet ? 1.0f : 0.0f);
+  return FileUtil::Hash(&planet, sizeof(float), hash);
+}
+
+void ThumbnailCache::Run() {
+  LowerPriority();
+  if (!FileUtil::CreateDir(dir)) {
+    return;
+  }
+
+  //Made on the first bake and reused, since every scene loads all the sounds.
+  //The tracks stay silent, the scene never plays them during a bake
+  sf::Music music_1;
+  sf::Music music_2;
+  std::unique_ptr<Scene> scene;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stop) {
+    //Loading is cheap, so once the menu is open it goes before baking
+    int load = -1;
+    int bake = -1;
+    for (int i = 0; i < num_levels; ++i) {
+      if (requested && states[i] == CACHED && load < 0) {
+        load = i;
+      } else if (states[i] == UNCHECKED && bake < 0) {
+        bake = i;
+      }
+    }
+
+    if (load >= 0) {
+      lock.unlock();
+      sf::Image image;
+      const bool success = image.loadFromFile(ImageName(load));
+      lock.lock();
+      images[load] = image;
+      states[load] = (success ? LOADED : FAILED);
+    } else if (bake >= 0) {
+      lock.unlock();
+      bool success = IsCached(bake);
+      if (!success) {
+        if (!scene) {
+          scene.reset(new Scene(&music_1, &music_2));
+        }
+        success = Bake(*scene, bake);
+      }
+      lock.lock();
+      states[bake] = (success ? CACHED : FAILED);
+    } else {
+      cv.wait(lock);
+    }
+  }
+}
+
+bool ThumbnailCache::IsCached(int level) const {
+  std::ifstream key_file(KeyName(level));
+  sf::Uint32 key = 0;
+  if (!(key_file >> std::hex >> key) || key != Key(all_levels[level])) {
+    return false;
+  }
+  return std::ifstream(ImageName(level)).good();
+}
+
+bool ThumbnailCache::Bake(Scene& scene, int level) {
+  //The camera smooths towards the orbit, so it must not start where the last level left it
+  scene.ResetCamera();
+  scene.StartSingle(level);
+  for (int i = 0; i < thumbnail_ticks; ++i) {
+    scene.UpdateCamera();
+  }
+
+  unsigned int width = thumbnail_width * thumbnail_supersample;
+  unsigned int height = thumbnail_height * thumbnail_supersample;
+  std::vector<unsigned char> rgba;
+  renderer.Render(scene, width, height, rgba);
+  FrameCapture::Downsample(rgba, width, height, thumbnail_supersample);
+
+  sf::Image image;
+  image.create(width, height, rgba.data());
+  if (!image.saveToFile(ImageName(level))) {
+    return false;
+  }
+  //The key goes last so a partly written image is never trusted
+  std::ofstream key_file(KeyName(level));
+  key_file << std::hex << Key(all_levels[level]);
+  return key_file.good();
+}
+
+std::string ThumbnailCache::ImageName(int level) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "/level_%02d.png", level);
+  return dir + name;
+}
+
+std::string ThumbnailCache::KeyName(int level) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "/level_%02d.key", level);
+  return dir + name;
+}
@@ -0,0 +1,76 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "CpuRenderer.h"
+#include "Level.h"
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Scene;
+
+//Level select previews. Each level is rendered once from its orbit camera by
+//a low priority thread and kept as a PNG in the save directory, next to a key
+//of the level parameters so edited levels are rendered again.
+class ThumbnailCache {
+public:
+  ThumbnailCache();
+  ~ThumbnailCache();
+
+  //Starts baking any missing or stale thumbnails under the save directory
+  void Start(const std::string& save_dir);
+  //Starts loading the thumbnails from disk, called when the level menu opens
+  void Request();
+  //Uploads the images that finished loading, must be called from the GL thread
+  void Update();
+
+  //Null until the thumbnail has been uploaded
+  const sf::Texture* Get(int level) const;
+
+  //Changes whenever anything visible in the thumbnail changes
+  static sf::Uint32 Key(const Level& level);
+
+private:
+  enum State {
+    UNCHECKED,
+    CACHED,
+    LOADED,
+    FAILED
+  };
+
+  void Run();
+  bool IsCached(int level) const;
+  bool Bake(Scene& scene, int level);
+  std::string ImageName(int level) const;
+  std::string KeyName(int level) const;
+
+  std::string dir;
+  CpuRenderer renderer;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool requested;
+  bool stop;
+  State states[num_levels];
+  sf::Image images[num_levels];
+
+  //Only touched by the GL thread
+  sf::Texture textures[num_levels];
+  bool uploaded[num_levels];
+};
@@ -0,0 +1,117 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "TileScheduler.h"
+#include <algorithm>
+
+TileScheduler::TileScheduler(int max_per_worker) :
+  max_per_worker(max_per_worker) {
+}
+
+void TileScheduler::AddFrame(int frame, unsigned int width, unsigned int height, unsigned int tile_size) {
+  int count = 0;
+  for (unsigned int y = 0; y < height; y += tile_size) {
+    for (unsigned int x = 0; x < width; x += tile_size) {
+      TileState state;
+      state.tile.frame = frame;
+      state.tile.x = x;
+      state.tile.y = y;
+      state.tile.w = std::min(tile_size, width - x);
+      state.tile.h = std::min(tile_size, height - y);
+      state.done = false;
+      queue.push_back(int(tiles.size()));
+      tiles.push_back(state);
+      count += 1;
+    }
+  }
+  frame_remaining[frame] += count;
+}
+
+int TileScheduler::Assign(int worker) {
+  if (NumAssigned(worker) >= max_per_worker) {
+    return -1;
+  }
+  while (!queue.empty()) {
+    const int tile = queue.front();
+    queue.pop_front();
+    if (!tiles[tile].done) {
+      Give(worker, tile);
+      return tile;
+    }
+  }
+
+  //Nothing queued, duplicate the oldest tile that only one other worker has
+  const std::vector<int>& mine = assigned[worker];
+  int best = -1;
+  for (std::map<int, std::vector<int>>::const_iterator it = assigned.begin(); it != assigned.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      const int tile = it->second[i];
+      if (!tiles[tile].done && tiles[tile].workers.size() == 1 &&
+          std::find(mine.begin(), mine.end(), tile) == mine.end() && (best < 0 || tile < best)) {
+        best = tile;
+      }
+    }
+  }
+  if (best >= 0) {
+    Give(worker, best);
+  }
+  return best;
+}
+
+bool TileScheduler::Complete(int worker, int tile) {
+  std::vector<int>& mine = assigned[worker];
+  mine.erase(std::remove(mine.begin(), mine.end(), tile), mine.end());
+  std::vector<int>& workers = tiles[tile].workers;
+  workers.erase(std::remove(workers.begin(), workers.end(), worker), workers.end());
+  if (tiles[tile].done) {
+    return false;
+  }
+  tiles[tile].done = true;
+  frame_remaining[tiles[tile].tile.frame] -= 1;
+  return true;
+}
+
+void TileScheduler::RemoveWorker(int worker) {
+  std::map<int, std::vector<int>>::iterator it = assigned.find(worker);
+  if (it == assigned.end()) {
+    return;
+  }
+  //Requeued tiles go first since they are the oldest
+  for (size_t i = it->second.size(); i-- > 0;) {
+    const int tile = it->second[i];
+    std::vector<int>& workers = tiles[tile].workers;
+    workers.erase(std::remove(workers.begin(), workers.end(), worker), workers.end());
+    if (!tiles[tile].done && workers.empty()) {
+      queue.push_front(tile);
+    }
+  }
+  assigned.erase(it);
+}
+
+bool TileScheduler::IsFrameDone(int frame) const {
+  std::map<int, int>::const_iterator it = frame_remaining.find(frame);
+  return it != frame_remaining.end() && it->second == 0;
+}
+
+int TileScheduler::NumAssigned(int worker) const {
+  std::map<int, std::vector<int>>::const_iterator it = assigned.find(worker);
+  return (it == assigned.end() ? 0 : int(it->second.size()));
+}
+
+void TileScheduler::Give(int worker, int tile) {
+  assigned[worker].push_back(tile);
+  tiles[tile].workers.push_back(worker);
+}
@@ -0,0 +1,68 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <deque>
+#include <map>
+#include <vector>
+
+//A rectangle of one frame in output pixels, top row first
+struct Tile {
+  int frame;
+  unsigned int x;
+  unsigned int y;
+  unsigned int w;
+  unsigned int h;
+};
+
+//Hands tiles to workers as they ask for them. Once the queue is empty, idle
+//workers take a second copy of tiles still running elsewhere, so a slow
+//worker or an expensive tile can't hold up the end of a frame.
+class TileScheduler {
+public:
+  TileScheduler(int max_per_worker);
+
+  //Splits a frame into tiles and queues them in row order
+  void AddFrame(int frame, unsigned int width, unsigned int height, unsigned int tile_size);
+
+  //Next tile for the worker, or -1 if it has enough or nothing is left
+  int Assign(int worker);
+  //False if another worker already finished the tile
+  bool Complete(int worker, int tile);
+  //Requeues tiles that no other worker is running
+  void RemoveWorker(int worker);
+
+  const Tile& GetTile(int tile) const { return tiles[tile].tile; }
+  bool IsFrameDone(int frame) const;
+  int NumAssigned(int worker) const;
+  int NumQueued() const { return int(queue.size()); }
+  int NumTiles() const { return int(tiles.size()); }
+
+private:
+  struct TileState {
+    Tile tile;
+    bool done;
+    std::vector<int> workers;
+  };
+
+  void Give(int worker, int tile);
+
+  int max_per_worker;
+  std::vector<TileState> tiles;
+  std::deque<int> queue;
+  std::map<int, int> frame_remaining;
+  std::map<int, std::vector<int>> assigned;
+};
@@ -0,0 +1,126 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "UniformBlock.h"
+#include <algorithm>
+#include <sstream>
+
+UniformBlock::UniformBlock(const Layout* _layout, int count) :
+  layout(_layout, _layout + count),
+  uploaded_to(nullptr) {
+  int offset = 0;
+  for (int i = 0; i < count; ++i) {
+    offsets.push_back(offset);
+    offset += layout[i].size;
+  }
+  values.resize(offset, 0.0f);
+  uploaded.resize(offset, 0.0f);
+}
+
+void UniformBlock::Set(int ix, float x, float y, float z) {
+  values[offsets[ix]] = x;
+  values[offsets[ix] + 1] = y;
+  values[offsets[ix] + 2] = z;
+}
+
+void UniformBlock::Set(int ix, float x, float y, float z, float w) {
+  Set(ix, x, y, z);
+  values[offsets[ix] + 3] = w;
+}
+
+void UniformBlock::Set(int ix, const float* mat4) {
+  std::copy(mat4, mat4 + 16, values.begin() + offsets[ix]);
+}
+
+const float* UniformBlock::Find(const std::string& name) const {
+  for (size_t i = 0; i < layout.size(); ++i) {
+    if (name == layout[i].name) {
+      return &values[offsets[i]];
+    }
+  }
+  return nullptr;
+}
+
+std::vector<int> UniformBlock::Changed() const {
+  std::vector<int> changed;
+  for (size_t i = 0; i < layout.size(); ++i) {
+    const int offset = offsets[i];
+    if (!std::equal(values.begin() + offset, values.begin() + offset + layout[i].size, uploaded.begin() + offset)) {
+      changed.push_back(int(i));
+    }
+  }
+  return changed;
+}
+
+void UniformBlock::Upload(sf::Shader& shader) {
+  std::vector<int> changed;
+  if (uploaded_to == &shader) {
+    changed = Changed();
+  } else {
+    for (size_t i = 0; i < layout.size(); ++i) {
+      changed.push_back(int(i));
+    }
+  }
+
+  for (size_t i = 0; i < changed.size(); ++i) {
+    const Layout& u = layout[changed[i]];
+    const float* v = &values[offsets[changed[i]]];
+    if (u.size == 16) {
+      shader.setUniform(u.name, sf::Glsl::Mat4(v));
+    } else if (u.size == 3) {
+      shader.setUniform(u.name, sf::Glsl::Vec3(v[0], v[1], v[2]));
+    } else if (u.size == 4) {
+      shader.setUniform(u.name, sf::Glsl::Vec4(v[0], v[1], v[2], v[3]));
+    } else {
+      shader.setUniform(u.name, v[0]);
+    }
+  }
+  uploaded = values;
+  uploaded_to = &shader;
+}
+
+void UniformBlock::Save(std::ostream& out) const {
+  out.precision(9);
+  for (size_t i = 0; i < layout.size(); ++i) {
+    out << layout[i].name;
+    for (int j = 0; j < layout[i].size; ++j) {
+      out << " " << values[offsets[i] + j];
+    }
+    out << "\n";
+  }
+}
+
+bool UniformBlock::Load(std::istream& in) {
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream line_in(line);
+    std::string name;
+    if (!(line_in >> name)) {
+      continue;
+    }
+    for (size_t i = 0; i < layout.size(); ++i) {
+      if (name != layout[i].name) {
+        continue;
+      }
+      for (int j = 0; j < layout[i].size; ++j) {
+        if (!(line_in >> values[offsets[i] + j])) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
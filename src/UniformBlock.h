@@ -0,0 +1,60 @@
+/* This file is part of the Marble Marcher (https://github.com/HackerPoet/MarbleMarcher).
+* Copyright(C) 2018 CodeParade
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* 
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//Shader uniforms kept as one float array, only changed values are uploaded
+class UniformBlock {
+public:
+  struct Layout {
+    const char* name;
+    int size; //1, 3, 4 or 16 floats
+  };
+
+  UniformBlock(const Layout* layout, int count);
+
+  void Set(int ix, float v) { values[offsets[ix]] = v; }
+  void Set(int ix, float x, float y, float z);
+  void Set(int ix, float x, float y, float z, float w);
+  void Set(int ix, const float* mat4);
+
+  //Indices of the uniforms that differ from the last upload
+  std::vector<int> Changed() const;
+  //Uploads what changed, or everything when the shader is different
+  void Upload(sf::Shader& shader);
+  //Forces a full upload after the shader was modified elsewhere
+  void Invalidate() { uploaded_to = nullptr; }
+
+  const std::vector<float>& GetValues() const { return values; }
+  //First value of the named uniform, nullptr if there is none
+  const float* Find(const std::string& name) const;
+
+  //One "name v0 v1 ..." line per uniform
+  void Save(std::ostream& out) const;
+  bool Load(std::istream& in);
+
+private:
+  std::vector<Layout> layout;
+  std::vector<int> offsets;
+  std::vector<float> values;
+  std::vector<float> uploaded;
+  const sf::Shader* uploaded_to;
+};
@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "CpuRenderer.h"
+#include "CpuRenderer.cpp"
+#include "Scene.h"
+#include "Scene.cpp"
+#include "Level.h"
+#include "Level.cpp"
+#include "Scores.h"
+#include "Scores.cpp"
+#include "UniformBlock.h"
+#include "UniformBlock.cpp"
+
+TEST(CpuRenderer, PacketDEMatchesScalar) {
+	sf::Music m1;
+	sf::Music m2;
+	Scene scene(&m1, &m2);
+	scene.SetMode(Camera::SCREEN_SAVER);
+	scene.UpdateCamera();
+
+	Scene::Packet x, y, z;
+	for (int i = 0; i < 8; ++i) {
+		x[i] = -3.0f + 0.9f * float(i);
+		y[i] = 2.0f - 0.4f * float(i);
+		z[i] = 0.25f * float(i * i) - 1.0f;
+	}
+	const Scene::Packet d = scene.DE(x, y, z);
+	for (int i = 0; i < 8; ++i) {
+		const float expected = scene.DE(Eigen::Vector3f(x[i], y[i], z[i]));
+		EXPECT_NEAR(d[i], expected, 1e-4f * std::max(1.0f, std::abs(expected)));
+	}
+}
+
+TEST(CpuRenderer, SameImageOnAnyThreadCount) {
+	sf::Music m1;
+	sf::Music m2;
+	Scene scene(&m1, &m2);
+	scene.SetMode(Camera::SCREEN_SAVER);
+	for (int i = 0; i < 10; ++i) {
+		scene.UpdateCamera();
+	}
+
+	std::vector<unsigned char> single, multi;
+	CpuRenderer(1).Render(scene, 37, 21, single);
+	CpuRenderer(4).Render(scene, 37, 21, multi);
+	ASSERT_EQ(single.size(), 37u * 21u * 4u);
+	EXPECT_EQ(single, multi);
+
+	//The fractal is in view, so not every pixel is the sky
+	bool varied = false;
+	for (size_t i = 4; i < single.size(); ++i) {
+		varied = varied || single[i] != single[i % 4];
+	}
+	EXPECT_TRUE(varied);
+}
+
+TEST(CpuRenderer, ExploreMatchesMarbleView) {
+	sf::Music m1;
+	sf::Music m2;
+	Scene scene(&m1, &m2);
+	scene.StartSingle(0);
+	scene.ResetLevel();
+	scene.SetMode(Camera::MARBLE);
+	scene.SnapCamera();
+	scene.UpdateCamera();
+
+	CpuRenderer renderer(1);
+	std::vector<unsigned char> marble, explore;
+	renderer.Render(scene, 37, 21, marble);
+
+	//Entering the explorer without moving must not change the view
+	scene.SetMode(Camera::EXPLORE);
+	renderer.Render(scene, 37, 21, explore);
+	ASSERT_EQ(marble.size(), explore.size());
+
+	//The origin round trip costs a little float precision, allow an edge pixel or two
+	int differ = 0;
+	for (size_t i = 0; i < marble.size(); ++i) {
+		differ += (std::abs(int(marble[i]) - int(explore[i])) > 2) ? 1 : 0;
+	}
+	EXPECT_LE(differ, 8);
+}
@@ -0,0 +1,62 @@
+#include "pch.h"
+#include "DynamicRes.h"
+#include "DynamicRes.cpp"
+#include "FrameTimeFilter.h"
+#include "FrameTimeFilter.cpp"
+
+//Simulated frame time for a view whose full resolution cost is full_ms
+static float SimFrame(const DynamicRes& dyn_res, float full_ms, int frame) {
+	const float noise = 0.03f * float((frame * 7919) % 13 - 6) / 6.0f;
+	return full_ms * dyn_res.GetScale() * dyn_res.GetScale() * (1.0f + noise);
+}
+
+TEST(DynamicResolution, ConvergesToTarget) {
+	DynamicRes dyn_res(14.0f, 0.5f, 1.0f);
+	for (int i = 0; i < 300; ++i) {
+		dyn_res.Update(SimFrame(dyn_res, 28.0f, i));
+	}
+	const float ms = 28.0f * dyn_res.GetScale() * dyn_res.GetScale();
+	EXPECT_LT(ms, 14.0f * 1.1f);
+	EXPECT_GT(ms, 14.0f * 0.8f);
+}
+
+TEST(DynamicResolution, StableAfterConverging) {
+	DynamicRes dyn_res(14.0f, 0.5f, 1.0f);
+	for (int i = 0; i < 300; ++i) {
+		dyn_res.Update(SimFrame(dyn_res, 28.0f, i));
+	}
+	const float scale = dyn_res.GetScale();
+	for (int i = 300; i < 600; ++i) {
+		EXPECT_EQ(dyn_res.Update(SimFrame(dyn_res, 28.0f, i)), scale);
+	}
+}
+
+TEST(DynamicResolution, RecoversFromCostSpike) {
+	//Orbit shot followed by an expensive close-up and back again
+	DynamicRes dyn_res(14.0f, 0.5f, 1.0f);
+	for (int i = 0; i < 100; ++i) {
+		dyn_res.Update(SimFrame(dyn_res, 10.0f, i));
+	}
+	EXPECT_EQ(dyn_res.GetScale(), 1.0f);
+	for (int i = 100; i < 200; ++i) {
+		dyn_res.Update(SimFrame(dyn_res, 40.0f, i));
+	}
+	EXPECT_LT(40.0f * dyn_res.GetScale() * dyn_res.GetScale(), 14.0f * 1.1f);
+	for (int i = 200; i < 300; ++i) {
+		dyn_res.Update(SimFrame(dyn_res, 10.0f, i));
+	}
+	EXPECT_EQ(dyn_res.GetScale(), 1.0f);
+}
+
+TEST(DynamicResolution, StaysWithinBounds) {
+	DynamicRes dyn_res(14.0f, 0.5f, 0.9f);
+	EXPECT_EQ(dyn_res.GetScale(), 0.9f);
+	for (int i = 0; i < 200; ++i) {
+		EXPECT_GE(dyn_res.Update(SimFrame(dyn_res, 200.0f, i)), 0.5f);
+	}
+	EXPECT_EQ(dyn_res.GetScale(), 0.5f);
+	for (int i = 0; i < 200; ++i) {
+		EXPECT_LE(dyn_res.Update(SimFrame(dyn_res, 1.0f, i)), 0.9f);
+	}
+	EXPECT_EQ(dyn_res.GetScale(), 0.9f);
+}
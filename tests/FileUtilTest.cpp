@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "FileUtil.h"
+#include "FileUtil.cpp"
+#include <cstdio>
+#include <fstream>
+
+TEST(FileUtil, HashIsFNV1a) {
+	EXPECT_EQ(FileUtil::Hash("", 0), 2166136261u);
+	EXPECT_EQ(FileUtil::Hash("a", 1), 0xe40c292cu);
+	EXPECT_EQ(FileUtil::Hash("foobar", 6), 0xbf9cf968u);
+}
+
+TEST(FileUtil, HashChains) {
+	const float values[] = { 1.0f, -2.5f, 3e-5f, 42.0f };
+	const sf::Uint32 whole = FileUtil::Hash(values, sizeof(values));
+	const sf::Uint32 first = FileUtil::Hash(values, 2 * sizeof(float));
+	EXPECT_EQ(FileUtil::Hash(values + 2, 2 * sizeof(float), first), whole);
+	EXPECT_NE(FileUtil::Hash(values + 2, 2 * sizeof(float)), whole);
+}
+
+TEST(FileUtil, CreateDir) {
+	const std::string dir = "file_util_test_dir";
+	EXPECT_TRUE(FileUtil::CreateDir(dir));
+	//Already there is still a success
+	EXPECT_TRUE(FileUtil::CreateDir(dir));
+	std::remove(dir.c_str());
+
+	//A file in the way is not
+	const std::string file = "file_util_test_file";
+	std::ofstream(file.c_str()) << "scores";
+	EXPECT_FALSE(FileUtil::CreateDir(file));
+	std::remove(file.c_str());
+}
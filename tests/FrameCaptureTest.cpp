@@ -0,0 +1,79 @@
+#include "pch.h"
+#include "GLExt.h"
+#include "GLExt.cpp"
+#include "FrameCapture.h"
+#include "FrameCapture.cpp"
+
+TEST(FrameCapture, QOIHeader) {
+	const unsigned char pixels[] = { 255, 0, 0, 255, 255, 0, 0, 255 };
+	const std::vector<unsigned char> qoi = FrameCapture::EncodeQOI(pixels, 2, 1);
+	ASSERT_GE(qoi.size(), 14u);
+	EXPECT_EQ(std::string(qoi.begin(), qoi.begin() + 4), "qoif");
+	const unsigned char size[8] = { 0, 0, 0, 2, 0, 0, 0, 1 };
+	EXPECT_TRUE(std::equal(size, size + 8, qoi.begin() + 4));
+	EXPECT_EQ(qoi[12], 4);
+	EXPECT_EQ(qoi[13], 0);
+}
+
+TEST(FrameCapture, QOIDiffAndRun) {
+	const unsigned char pixels[] = { 255, 0, 0, 255, 255, 0, 0, 255 };
+	const std::vector<unsigned char> qoi = FrameCapture::EncodeQOI(pixels, 2, 1);
+	const std::vector<unsigned char> expected = { 0x5A, 0xC0, 0, 0, 0, 0, 0, 0, 0, 1 };
+	EXPECT_EQ(std::vector<unsigned char>(qoi.begin() + 14, qoi.end()), expected);
+}
+
+TEST(FrameCapture, QOIIndexAndFullColor) {
+	const unsigned char pixels[] = {
+		10, 200, 30, 255,
+		10, 200, 30, 128,
+		10, 200, 30, 255,
+	};
+	const std::vector<unsigned char> qoi = FrameCapture::EncodeQOI(pixels, 3, 1);
+	const int hash = (10*3 + 200*5 + 30*7 + 255*11) % 64;
+	const std::vector<unsigned char> expected = {
+		0xFE, 10, 200, 30,
+		0xFF, 10, 200, 30, 128,
+		(unsigned char)hash,
+		0, 0, 0, 0, 0, 0, 0, 1
+	};
+	EXPECT_EQ(std::vector<unsigned char>(qoi.begin() + 14, qoi.end()), expected);
+}
+
+TEST(FrameCapture, QOILongRunSplits) {
+	std::vector<unsigned char> black(100 * 4, 0);
+	for (size_t i = 3; i < black.size(); i += 4) { black[i] = 255; }
+	const std::vector<unsigned char> qoi = FrameCapture::EncodeQOI(black.data(), 100, 1);
+	const std::vector<unsigned char> expected = { 0xC0 | 61, 0xC0 | 37, 0, 0, 0, 0, 0, 0, 0, 1 };
+	EXPECT_EQ(std::vector<unsigned char>(qoi.begin() + 14, qoi.end()), expected);
+}
+
+TEST(FrameCapture, DownsampleAverages) {
+	std::vector<unsigned char> pixels = {
+		0, 0, 0, 255,     100, 0, 0, 255,    7, 7, 7, 255,
+		200, 0, 0, 255,   100, 40, 0, 255,   7, 7, 7, 255,
+	};
+	unsigned int width = 3;
+	unsigned int height = 2;
+	FrameCapture::Downsample(pixels, width, height, 2);
+	EXPECT_EQ(width, 1u);
+	EXPECT_EQ(height, 1u);
+	const std::vector<unsigned char> expected = { 100, 10, 0, 255 };
+	EXPECT_EQ(pixels, expected);
+}
+
+TEST(FrameCapture, SaveEncodesOnFirstUse) {
+	const std::string fname = "frame_capture_test.qoi";
+	{
+		//The encoders only start with the first frame, and finish it before closing
+		FrameCapture capture;
+		std::vector<unsigned char> pixels = { 255, 0, 0, 255, 255, 0, 0, 255 };
+		capture.Save(pixels, 2, 1, fname, FrameCapture::QOI);
+		EXPECT_TRUE(pixels.empty());
+	}
+	std::ifstream fin(fname, std::ios::binary);
+	std::string magic(4, '\0');
+	fin.read(&magic[0], 4);
+	EXPECT_EQ(magic, "qoif");
+	fin.close();
+	std::remove(fname.c_str());
+}
@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "FrameTimeFilter.h"
+#include "FrameTimeFilter.cpp"
+
+TEST(FrameTimeFilter, SkipsSettlingFrames) {
+	FrameTimeFilter filter(10.0f, 0.8f, 1.05f);
+	for (int i = 0; i < settle_time; ++i) {
+		EXPECT_FALSE(filter.Update(100.0f + float(i)));
+	}
+	//Smoothing starts from the last settling frame
+	EXPECT_EQ(filter.GetSmoothTime(), 100.0f + float(settle_time - 1));
+	EXPECT_TRUE(filter.Update(10.0f));
+
+	filter.Settle();
+	EXPECT_FALSE(filter.Update(10.0f));
+	filter.Reset();
+	EXPECT_EQ(filter.GetSmoothTime(), 0.0f);
+	EXPECT_FALSE(filter.Update(10.0f));
+}
+
+TEST(FrameTimeFilter, SmoothsSpikes) {
+	FrameTimeFilter filter(10.0f, 0.8f, 1.05f);
+	for (int i = 0; i < 50; ++i) {
+		filter.Update(10.0f);
+	}
+	EXPECT_FLOAT_EQ(filter.GetSmoothTime(), 10.0f);
+	filter.Update(30.0f);
+	EXPECT_FLOAT_EQ(filter.GetSmoothTime(), 10.0f + 20.0f * smooth_weight);
+	for (int i = 0; i < 100; ++i) {
+		filter.Update(20.0f);
+	}
+	EXPECT_NEAR(filter.GetSmoothTime(), 20.0f, 1e-3f);
+}
+
+TEST(FrameTimeFilter, Bands) {
+	FrameTimeFilter filter(10.0f, 0.8f, 1.05f);
+	const float times[] = { 7.0f, 9.0f, 10.4f, 11.0f };
+	const bool over[] = { false, false, false, true };
+	const bool under[] = { true, false, false, false };
+	for (int t = 0; t < 4; ++t) {
+		filter.Reset();
+		for (int i = 0; i <= settle_time; ++i) {
+			filter.Update(times[t]);
+		}
+		EXPECT_FLOAT_EQ(filter.GetRatio(), times[t] / 10.0f);
+		EXPECT_EQ(filter.IsOver(), over[t]) << times[t];
+		EXPECT_EQ(filter.IsUnder(), under[t]) << times[t];
+	}
+}
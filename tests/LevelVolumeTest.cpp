@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "LevelVolume.h"
+#include "LevelVolume.cpp"
+#include "CpuRenderer.h"
+#include "CpuRenderer.cpp"
+#include "FileUtil.h"
+#include "FileUtil.cpp"
+#include "Scene.h"
+#include "Scene.cpp"
+#include "Level.h"
+#include "Level.cpp"
+#include "Scores.h"
+#include "Scores.cpp"
+#include "UniformBlock.h"
+#include "UniformBlock.cpp"
+
+TEST(LevelVolume, ShadowsIndependentOfThreads) {
+	const std::vector<unsigned char> a = LevelVolume::BakeShadows(all_levels[0].params, 16, 1);
+	const std::vector<unsigned char> b = LevelVolume::BakeShadows(all_levels[0].params, 16, 3);
+	ASSERT_EQ(a.size(), size_t(16 * 16 * 16));
+	EXPECT_EQ(a, b);
+}
+
+TEST(LevelVolume, ShadowsMatchMarching) {
+	//Texels inside the fractal are dark, texels with a clear view of the light are lit
+	const FractalParams& params = all_levels[0].params;
+	const int res = 16;
+	const std::vector<unsigned char> volume = LevelVolume::BakeShadows(params, res, 2);
+	const float bound = Scene::FractalBound(params);
+	const float texel = 2.0f * bound / float(res);
+	int lit = 0;
+	int dark = 0;
+	for (int z = 0; z < res; ++z) {
+		for (int y = 0; y < res; ++y) {
+			for (int x = 0; x < res; ++x) {
+				const unsigned char v = volume[(z * res + y) * res + x];
+				const Scene::Packet p = Scene::Packet::Constant(-bound + 0.5f * texel);
+				const float d = Scene::DE(params, p + x * texel, p + y * texel, p + z * texel)[0];
+				if (d < 0.0f) {
+					EXPECT_EQ(v, 0);
+					dark += 1;
+				}
+				lit += (v == 255 ? 1 : 0);
+			}
+		}
+	}
+	EXPECT_GT(dark, 0);
+	EXPECT_GT(lit, 0);
+}
+
+TEST(LevelVolume, DistancesAreConservative) {
+	//The lookup must never step further than the exact DE allows
+	for (int level = 0; level < num_levels; level += 4) {
+		const FractalParams& params = all_levels[level].params;
+		const int res = 32;
+		const float bound = Scene::FractalBound(params);
+		const std::vector<unsigned char> distances = LevelVolume::BakeDistances(params, res, 2);
+		int far = 0;
+		unsigned int seed = 1;
+		for (int i = 0; i < 4000; ++i) {
+			Eigen::Vector3f p;
+			for (int j = 0; j < 3; ++j) {
+				seed = seed * 1103515245u + 12345u;
+				p[j] = (float((seed >> 8) & 0xffff) / 65535.0f * 2.0f - 1.0f) * bound;
+			}
+			const float d = Scene::DE(params, Scene::Packet::Constant(p.x()), Scene::Packet::Constant(p.y()), Scene::Packet::Constant(p.z()))[0];
+			const float sampled = LevelVolume::SampleDistance(distances, res, bound, p);
+			EXPECT_LE(sampled, std::max(d, 0.0f)) << "level " << level << " at " << p.transpose();
+			far += (sampled > 0.0f ? 1 : 0);
+		}
+		EXPECT_GT(far, 1000);
+	}
+}
+
+TEST(LevelVolume, AtlasLayout) {
+	std::vector<unsigned char> volume(20 * 20 * 20);
+	for (size_t i = 0; i < volume.size(); ++i) {
+		volume[i] = (unsigned char)(i / 400);
+	}
+	const std::vector<unsigned char> distances(volume.size(), 9);
+	const sf::Image atlas = LevelVolume::MakeAtlas(volume, distances, 20);
+	EXPECT_EQ(atlas.getSize(), sf::Vector2u(320, 40));
+	EXPECT_EQ(atlas.getPixel(0, 0).r, 0);
+	EXPECT_EQ(atlas.getPixel(20 * 3 + 5, 7).r, 3);
+	EXPECT_EQ(atlas.getPixel(20 * 1 + 19, 20 + 19).r, 17);
+	EXPECT_EQ(atlas.getPixel(20 * 1 + 19, 20 + 19).g, 9);
+}
+
+TEST(LevelVolume, KeyFollowsParams) {
+	FractalParams params = all_levels[0].params;
+	const sf::Uint32 key = LevelVolume::Key(params);
+	EXPECT_EQ(LevelVolume::Key(params), key);
+	params[0] += 0.001f;
+	EXPECT_NE(LevelVolume::Key(params), key);
+}
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "MarbleProbe.h"
+#include "MarbleProbe.cpp"
+#include "Renderer.h"
+#include "Renderer.cpp"
+#include "Scene.h"
+#include "Scene.cpp"
+#include "Level.h"
+#include "Level.cpp"
+#include "Scores.h"
+#include "Scores.cpp"
+#include "UniformBlock.h"
+#include "UniformBlock.cpp"
+
+TEST(MarbleProbe, FacesCoverAxes) {
+	const Eigen::Vector3f pos(1.0f, 2.0f, 3.0f);
+	const Eigen::Vector3f axes[MarbleProbe::num_faces] = {
+		Eigen::Vector3f::UnitX(), -Eigen::Vector3f::UnitX(),
+		Eigen::Vector3f::UnitY(), -Eigen::Vector3f::UnitY(),
+		Eigen::Vector3f::UnitZ(), -Eigen::Vector3f::UnitZ(),
+	};
+	for (int i = 0; i < MarbleProbe::num_faces; ++i) {
+		const Eigen::Matrix4f mat = MarbleProbe::FaceMatrix(i, pos);
+		const Eigen::Matrix3f rot = mat.topLeftCorner(3, 3);
+		const Eigen::Vector3f forward = -mat.col(2).head(3);
+		const Eigen::Vector3f origin = mat.col(3).head(3);
+		EXPECT_TRUE(forward.isApprox(axes[i])) << "face " << i;
+		EXPECT_TRUE(origin.isApprox(pos));
+		EXPECT_NEAR(rot.determinant(), 1.0f, 1e-6f);
+		EXPECT_TRUE((rot * rot.transpose()).isIdentity(1e-6f));
+	}
+}
+
+TEST(MarbleProbe, FaceCornersMeet) {
+	//The top-right corner ray of +x is shared with the faces it touches
+	const Eigen::Matrix4f px = MarbleProbe::FaceMatrix(0, Eigen::Vector3f::Zero());
+	const Eigen::Vector3f corner = (px * Eigen::Vector4f(1.0f, 1.0f, -1.0f, 0.0f)).head<3>();
+	int touching = 0;
+	for (int i = 1; i < MarbleProbe::num_faces; ++i) {
+		const Eigen::Matrix4f mat = MarbleProbe::FaceMatrix(i, Eigen::Vector3f::Zero());
+		const Eigen::Matrix3f rot = mat.topLeftCorner(3, 3);
+		const Eigen::Vector3f local = rot.transpose() * corner;
+		if (std::abs(local.z() + 1.0f) < 1e-5f) {
+			EXPECT_NEAR(std::abs(local.x()), 1.0f, 1e-5f);
+			EXPECT_NEAR(std::abs(local.y()), 1.0f, 1e-5f);
+			touching += 1;
+		}
+	}
+	EXPECT_EQ(touching, 2);
+}
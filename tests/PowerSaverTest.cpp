@@ -0,0 +1,44 @@
+#include "pch.h"
+#include "PowerSaver.h"
+#include "PowerSaver.cpp"
+
+TEST(PowerSaving, IdleAfterTimeout) {
+	PowerSaver power(60.0f);
+	for (int i = 0; i < 59; ++i) {
+		EXPECT_EQ(power.Update(1.0f, true, false), PowerSaver::ACTIVE);
+	}
+	EXPECT_EQ(power.Update(1.0f, true, false), PowerSaver::IDLE);
+	EXPECT_LT(power.GetScale(), 1.0f);
+	EXPECT_LT(power.GetFPS(), 60.0f);
+}
+
+TEST(PowerSaving, InputRestoresInstantly) {
+	PowerSaver power(60.0f);
+	power.Update(100.0f, true, false);
+	EXPECT_EQ(power.GetState(), PowerSaver::IDLE);
+	EXPECT_EQ(power.Update(0.01f, true, true), PowerSaver::ACTIVE);
+	EXPECT_EQ(power.GetScale(), 1.0f);
+	EXPECT_EQ(power.GetFPS(), 60.0f);
+}
+
+TEST(PowerSaving, Unfocused) {
+	PowerSaver power(60.0f);
+	EXPECT_EQ(power.Update(0.01f, false, true), PowerSaver::UNFOCUSED);
+	EXPECT_EQ(power.Update(0.01f, true, false), PowerSaver::ACTIVE);
+}
+
+TEST(PowerSaving, TimePerState) {
+	PowerSaver power(10.0f);
+	power.Update(4.0f, true, true);
+	power.AddFrame();
+	power.Update(10.0f, true, false);
+	power.AddFrame();
+	power.Update(3.0f, false, false);
+	power.Update(2.0f, true, true);
+
+	EXPECT_FLOAT_EQ(power.GetTime(PowerSaver::ACTIVE), 14.0f);
+	EXPECT_FLOAT_EQ(power.GetTime(PowerSaver::IDLE), 3.0f);
+	EXPECT_FLOAT_EQ(power.GetTime(PowerSaver::UNFOCUSED), 2.0f);
+	EXPECT_EQ(power.GetFrames(PowerSaver::ACTIVE), 1);
+	EXPECT_EQ(power.GetFrames(PowerSaver::IDLE), 1);
+}
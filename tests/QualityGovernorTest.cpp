@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "QualityGovernor.h"
+#include "QualityGovernor.cpp"
+#include "FrameTimeFilter.h"
+#include "FrameTimeFilter.cpp"
+
+//Drops the detail once from full with a frame far over the target
+static void DropDetail(QualityGovernor& governor) {
+	for (int i = 0; i <= settle_time; ++i) {
+		governor.Update(1000.0f);
+	}
+}
+
+TEST(QualityGovernor, DropsAtOnce) {
+	QualityGovernor governor(10.0f);
+	for (int i = 0; i < settle_time; ++i) {
+		EXPECT_EQ(governor.Update(1000.0f), 1.0f);
+	}
+	EXPECT_FLOAT_EQ(governor.Update(1000.0f), 1.0f - max_drop);
+}
+
+TEST(QualityGovernor, RisesOnlyAfterHeadroom) {
+	QualityGovernor governor(10.0f);
+	DropDetail(governor);
+	const float dropped = governor.GetDetail();
+	ASSERT_LT(dropped, 1.0f);
+	for (int i = 0; i < settle_time + headroom_time - 1; ++i) {
+		EXPECT_EQ(governor.Update(5.0f), dropped);
+	}
+	EXPECT_FLOAT_EQ(governor.Update(5.0f), dropped + raise_step);
+}
+
+TEST(QualityGovernor, HoldsInBand) {
+	QualityGovernor governor(10.0f);
+	DropDetail(governor);
+	const float dropped = governor.GetDetail();
+	for (int i = 0; i < 500; ++i) {
+		EXPECT_EQ(governor.Update(9.0f), dropped);
+	}
+}
+
+TEST(QualityGovernor, ResetRestoresFullDetail) {
+	QualityGovernor governor(10.0f);
+	DropDetail(governor);
+	governor.Reset();
+	EXPECT_EQ(governor.GetDetail(), 1.0f);
+	//And waits for the full detail frames before judging them
+	for (int i = 0; i < settle_time; ++i) {
+		EXPECT_EQ(governor.Update(1000.0f), 1.0f);
+	}
+}
+
+TEST(QualityGovernor, DetailLimits) {
+	QualityGovernor governor(14.0f);
+	governor.SetFullDetail(600.0f, 3e-5f, 10.0f);
+	EXPECT_EQ(governor.GetMaxMarches(), 600.0f);
+	EXPECT_FLOAT_EQ(governor.GetMinDist(), 3e-5f);
+	EXPECT_FLOAT_EQ(governor.GetShadowSharpness(), 10.0f);
+	for (int i = 0; i < 200; ++i) {
+		governor.Update(1000.0f);
+	}
+	EXPECT_EQ(governor.GetDetail(), 0.0f);
+	EXPECT_EQ(governor.GetMaxMarches(), 150.0f);
+	EXPECT_FLOAT_EQ(governor.GetMinDist(), 3e-4f);
+	EXPECT_FLOAT_EQ(governor.GetShadowSharpness(), 40.0f);
+}
@@ -8,6 +8,8 @@
 #include "Scores.h"
 #include "Scores.cpp"
 #include "SelectRes.h"
+#include "UniformBlock.h"
+#include "UniformBlock.cpp"
 #include "Marble.h"
 #include "Camera.h"
 
@@ -310,4 +312,128 @@ TEST(SceneFunctions, UpdateCamera) {
 
 	EXPECT_EQ(1, s5.GetTimer());
 	EXPECT_EQ(-0.25f, s5.GetCamera().GetLookY());
-}
\ No newline at end of file
+}
+
+TEST(SceneFunctions, FractalBound) {
+	sf::Music m1;
+	sf::Music m2;
+	m1.openFromFile(level1_ogg);
+	m2.openFromFile(level2_ogg);
+	Scene s(&m1, &m2);
+
+	for (int i = 0; i < num_levels; ++i) {
+		s.StartSingle(i);
+		s.ResetLevel();
+		const float r = s.FractalBound();
+
+		EXPECT_GT(r, all_levels[i].start_pos.norm());
+		EXPECT_GT(s.DE(Eigen::Vector3f(r, 0.0f, 0.0f)), 0.0f);
+		EXPECT_GT(s.DE(Eigen::Vector3f(0.0f, r, 0.0f)), 0.0f);
+		EXPECT_GT(s.DE(Eigen::Vector3f(0.0f, 0.0f, -r)), 0.0f);
+		EXPECT_GT(s.DE(Eigen::Vector3f(-r, r, r).normalized() * r), 0.0f);
+	}
+}
+
+TEST(SceneFunctions, DENormal) {
+	sf::Music m1;
+	sf::Music m2;
+	m1.openFromFile(level1_ogg);
+	m2.openFromFile(level2_ogg);
+	Scene s(&m1, &m2);
+
+	for (int i = 0; i < num_levels; ++i) {
+		s.StartSingle(i);
+		s.ResetLevel();
+		const Eigen::Vector3f p = all_levels[i].start_pos;
+		const Eigen::Vector3f n = s.DENormal(p);
+
+		EXPECT_NEAR(1.0f, n.norm(), 1e-4f);
+		EXPECT_GT(n.dot((p - s.NP(p)).normalized()), 0.999f);
+	}
+}
+
+TEST(SceneFunctions, DoubleDE) {
+	sf::Music m1;
+	sf::Music m2;
+	m1.openFromFile(level1_ogg);
+	m2.openFromFile(level2_ogg);
+	Scene s(&m1, &m2);
+
+	for (int i = 0; i < num_levels; ++i) {
+		s.StartSingle(i);
+		s.ResetLevel();
+		const Eigen::Vector3f p = all_levels[i].start_pos;
+		const float d = s.DE(p);
+
+		EXPECT_NEAR(d, float(s.DE(p.cast<double>(), 16)), 1e-4f * (1.0f + std::abs(d)));
+	}
+}
+
+TEST(SceneFunctions, DeepIters) {
+	EXPECT_EQ(0, Scene::DeepIters(1.0f, 2.0f));
+	EXPECT_EQ(0, Scene::DeepIters(1e-3f, 1.0f));
+	EXPECT_EQ(10, Scene::DeepIters(1e-3f, 2.0f));
+	EXPECT_EQ(32, Scene::DeepIters(1e-30f, 1.1f));
+}
+
+TEST(SceneFunctions, ExploreStaysOutside) {
+	sf::Music m1;
+	sf::Music m2;
+	m1.openFromFile(level1_ogg);
+	m2.openFromFile(level2_ogg);
+	Scene s(&m1, &m2);
+
+	for (int i = 0; i < num_levels; ++i) {
+		s.StartSingle(i);
+		s.ResetLevel();
+		s.SetMode(Camera::MARBLE);
+		s.UpdateCamera();
+		const int timer = s.GetTimer();
+		s.SetMode(Camera::EXPLORE);
+		const float d0 = s.DE(s.GetCamera().GetPosition());
+
+		//Fly straight at the marble, which sits on the surface
+		s.UpdateExplore(0.0f, -0.3f, 3.0f, 0.0f, 0.0f);
+		for (int j = 0; j < 2000; ++j) {
+			s.UpdateExplore(0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+		}
+
+		EXPECT_EQ(timer, s.GetTimer());
+		EXPECT_LE(s.GetDeepScale(), 1.0f);
+		if (d0 > 0.0f) {
+			EXPECT_GT(s.DE(s.GetCamera().GetPosition().cast<double>(), 48), -1e-6);
+		}
+	}
+}
+
+TEST(SceneFunctions, ExploredRunHasNoHighScore) {
+	sf::Music m1;
+	sf::Music m2;
+	m1.openFromFile(level1_ogg);
+	m2.openFromFile(level2_ogg);
+	Scene s(&m1, &m2);
+	const int level = num_levels - 1;
+	const int best = high_scores.Get(level);
+
+	//Scout the route, then roll into the flag
+	s.StartSingle(level);
+	s.ResetLevel();
+	s.SetMode(Camera::MARBLE);
+	s.SetMode(Camera::EXPLORE);
+	s.SetMode(Camera::MARBLE);
+	const Eigen::Vector3f flag = s.GetFlagPosition();
+	const float r = s.GetMarble().GetRadius();
+	s.SetMarble(flag.x(), flag.y() + (all_levels[level].planet ? -r : r), flag.z(), r);
+	s.CheckIfMarbleHasHitFlag();
+	ASSERT_EQ(s.GetMode(), Camera::GOAL);
+	EXPECT_EQ(high_scores.Get(level), best);
+	EXPECT_FALSE(s.IsHighScore());
+
+	//A fresh attempt counts again
+	s.ResetLevel();
+	s.SetMode(Camera::MARBLE);
+	s.SetMarble(flag.x(), flag.y() + (all_levels[level].planet ? -r : r), flag.z(), r);
+	s.CheckIfMarbleHasHitFlag();
+	ASSERT_EQ(s.GetMode(), Camera::GOAL);
+	EXPECT_TRUE(s.IsHighScore());
+}
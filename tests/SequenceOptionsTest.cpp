@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "GLExt.h"
+#include "GLExt.cpp"
+#include "FrameCapture.h"
+#include "FrameCapture.cpp"
+#include "SequenceOptions.h"
+#include "SequenceOptions.cpp"
+
+static bool ParseArgs(SequenceOptions& opts, std::vector<std::string> args) {
+	std::vector<char*> argv;
+	args.insert(args.begin(), "MarbleMarcher");
+	for (size_t i = 0; i < args.size(); ++i) {
+		argv.push_back(&args[i][0]);
+	}
+	return opts.Parse(int(argv.size()), argv.data());
+}
+
+TEST(SequenceOptions, NotRequested) {
+	SequenceOptions opts;
+	EXPECT_TRUE(ParseArgs(opts, {}));
+	EXPECT_FALSE(opts.requested);
+}
+
+TEST(SequenceOptions, Defaults) {
+	SequenceOptions opts;
+	EXPECT_TRUE(ParseArgs(opts, { "--render-sequence" }));
+	EXPECT_TRUE(opts.requested);
+	EXPECT_EQ(opts.out_dir, ".");
+	EXPECT_EQ(opts.path, SequenceOptions::SCREEN_SAVER);
+	EXPECT_EQ(opts.supersample, 1);
+	EXPECT_EQ(opts.FrameName(7), "./frame_00007.png");
+}
+
+TEST(SequenceOptions, AllOptions) {
+	SequenceOptions opts;
+	EXPECT_TRUE(ParseArgs(opts, { "--render-sequence", "out", "--path", "orbit", "--level", "3",
+		"--frames", "120", "--skip", "10", "--step", "2", "--size", "640x360",
+		"--supersample", "4", "--format", "qoi", "--quality", "low" }));
+	EXPECT_EQ(opts.out_dir, "out");
+	EXPECT_EQ(opts.path, SequenceOptions::ORBIT);
+	EXPECT_EQ(opts.level, 3);
+	EXPECT_EQ(opts.frames, 120);
+	EXPECT_EQ(opts.skip, 10);
+	EXPECT_EQ(opts.step, 2);
+	EXPECT_EQ(opts.width, 640u);
+	EXPECT_EQ(opts.height, 360u);
+	EXPECT_EQ(opts.supersample, 4);
+	EXPECT_EQ(opts.quality, "low");
+	EXPECT_EQ(opts.FrameName(123), "out/frame_00123.qoi");
+}
+
+TEST(SequenceOptions, Malformed) {
+	SequenceOptions opts;
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "--size", "640" }));
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "--size", "640x360x2" }));
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "--frames", "0" }));
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "--frames" }));
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "--path", "spiral" }));
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "--bogus", "1" }));
+	EXPECT_FALSE(ParseArgs(opts, { "--render-sequence", "a", "b" }));
+}
+
+TEST(SequenceOptions, Distributed) {
+	SequenceOptions coordinator;
+	EXPECT_TRUE(ParseArgs(coordinator, { "--render-sequence", "out", "--listen", "5000", "--tile", "64" }));
+	EXPECT_EQ(coordinator.listen_port, 5000);
+	EXPECT_EQ(coordinator.tile_size, 64u);
+	EXPECT_FALSE(coordinator.worker);
+
+	SequenceOptions worker;
+	EXPECT_TRUE(ParseArgs(worker, { "--render-worker", "localhost:5000" }));
+	EXPECT_TRUE(worker.worker);
+	EXPECT_FALSE(worker.requested);
+	EXPECT_EQ(worker.worker_host, "localhost");
+	EXPECT_EQ(worker.worker_port, 5000);
+
+	EXPECT_FALSE(ParseArgs(worker, { "--render-worker", "localhost" }));
+	EXPECT_FALSE(ParseArgs(worker, { "--render-worker", ":5000" }));
+	EXPECT_FALSE(ParseArgs(worker, { "--render-sequence", "--listen", "70000" }));
+}
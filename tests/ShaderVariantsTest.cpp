@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "ShaderVariants.h"
+#include "ShaderVariants.cpp"
+#include <sstream>
+
+TEST(ShaderVariants, ParsePresets) {
+	std::istringstream in("# comment\n\nlow SHADOWS_ENABLED=0 MIN_DIST=1e-4 # trailing\nhigh\n");
+	const std::vector<QualityPreset> presets = ShaderVariants::ParsePresets(in);
+
+	ASSERT_EQ(presets.size(), 2u);
+	EXPECT_EQ(presets[0].name, "low");
+	ASSERT_EQ(presets[0].defines.size(), 2u);
+	EXPECT_EQ(presets[0].defines[0].first, "SHADOWS_ENABLED");
+	EXPECT_EQ(presets[0].defines[0].second, "0");
+	EXPECT_EQ(presets[0].defines[1].first, "MIN_DIST");
+	EXPECT_EQ(presets[0].defines[1].second, "1e-4");
+	EXPECT_EQ(presets[1].name, "high");
+	EXPECT_TRUE(presets[1].defines.empty());
+}
+
+TEST(ShaderVariants, ApplyPreset) {
+	std::string src = "#define MAX_MARCHES 1000\n#define MAX_MARCHES_X 5\n#define MIN_DIST 1e-5\r\nvoid main() {}\n";
+	QualityPreset preset;
+	preset.name = "low";
+	preset.defines.push_back(std::make_pair("MAX_MARCHES", "300"));
+	preset.defines.push_back(std::make_pair("MIN_DIST", "1e-4"));
+
+	EXPECT_TRUE(ShaderVariants::ApplyPreset(src, preset));
+	EXPECT_EQ(src, "#define MAX_MARCHES 300\n#define MAX_MARCHES_X 5\n#define MIN_DIST 1e-4\r\nvoid main() {}\n");
+}
+
+TEST(ShaderVariants, ApplyPresetMissingDefine) {
+	std::string src = "//#define FOG_ENABLED 0\n";
+	QualityPreset preset;
+	preset.defines.push_back(std::make_pair("FOG_ENABLED", "1"));
+
+	EXPECT_FALSE(ShaderVariants::ApplyPreset(src, preset));
+}
+
+TEST(ShaderVariants, FindDefine) {
+	const std::string src = "#define SHADOW_SHARPNESS_X 5\n#define SHADOW_SHARPNESS 10.0\r\n//#define MIN_DIST 1\n#define MAX_MARCHES 1000";
+
+	EXPECT_EQ(ShaderVariants::FindDefine(src, "SHADOW_SHARPNESS"), "10.0");
+	EXPECT_EQ(ShaderVariants::FindDefine(src, "MAX_MARCHES"), "1000");
+	EXPECT_EQ(ShaderVariants::FindDefine(src, "MIN_DIST"), "");
+}
@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "ThumbnailCache.h"
+#include "ThumbnailCache.cpp"
+#include "CpuRenderer.h"
+#include "CpuRenderer.cpp"
+#include "FrameCapture.h"
+#include "FrameCapture.cpp"
+#include "FileUtil.h"
+#include "FileUtil.cpp"
+#include "GLExt.h"
+#include "GLExt.cpp"
+#include "Scene.h"
+#include "Scene.cpp"
+#include "Level.h"
+#include "Level.cpp"
+#include "Scores.h"
+#include "Scores.cpp"
+#include "UniformBlock.h"
+#include "UniformBlock.cpp"
+
+TEST(ThumbnailCache, KeyPerLevel) {
+	for (int i = 0; i < num_levels; ++i) {
+		EXPECT_EQ(ThumbnailCache::Key(all_levels[i]), ThumbnailCache::Key(all_levels[i]));
+		for (int j = i + 1; j < num_levels; ++j) {
+			EXPECT_NE(ThumbnailCache::Key(all_levels[i]), ThumbnailCache::Key(all_levels[j]));
+		}
+	}
+}
+
+TEST(ThumbnailCache, KeyFollowsVisibleParams) {
+	const sf::Uint32 key = ThumbnailCache::Key(all_levels[0]);
+	Level level = all_levels[0];
+	level.start_look_x += 1.0f;
+	level.txt = "Renamed";
+	EXPECT_EQ(ThumbnailCache::Key(level), key);
+
+	level.params[1] += 0.01f;
+	EXPECT_NE(ThumbnailCache::Key(level), key);
+	level = all_levels[0];
+	level.end_pos.y() += 1.0f;
+	EXPECT_NE(ThumbnailCache::Key(level), key);
+}
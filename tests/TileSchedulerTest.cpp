@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "TileScheduler.h"
+#include "TileScheduler.cpp"
+
+TEST(TileScheduler, SplitsFrame) {
+	TileScheduler scheduler(100);
+	scheduler.AddFrame(0, 300, 200, 128);
+	ASSERT_EQ(scheduler.NumQueued(), 6);
+
+	std::vector<int> ids;
+	for (int i = 0; i < 6; ++i) {
+		ids.push_back(scheduler.Assign(0));
+	}
+	EXPECT_EQ(scheduler.GetTile(ids[0]).x, 0u);
+	EXPECT_EQ(scheduler.GetTile(ids[2]).x, 256u);
+	EXPECT_EQ(scheduler.GetTile(ids[2]).w, 44u);
+	EXPECT_EQ(scheduler.GetTile(ids[5]).y, 128u);
+	EXPECT_EQ(scheduler.GetTile(ids[5]).h, 72u);
+
+	for (int i = 0; i < 6; ++i) {
+		EXPECT_FALSE(scheduler.IsFrameDone(0));
+		EXPECT_TRUE(scheduler.Complete(0, ids[i]));
+	}
+	EXPECT_TRUE(scheduler.IsFrameDone(0));
+}
+
+TEST(TileScheduler, LimitsPerWorker) {
+	TileScheduler scheduler(2);
+	scheduler.AddFrame(0, 64, 64, 16);
+	EXPECT_GE(scheduler.Assign(0), 0);
+	EXPECT_GE(scheduler.Assign(0), 0);
+	EXPECT_EQ(scheduler.Assign(0), -1);
+	EXPECT_EQ(scheduler.NumAssigned(0), 2);
+	EXPECT_GE(scheduler.Assign(1), 0);
+}
+
+TEST(TileScheduler, StealsFromSlowWorker) {
+	TileScheduler scheduler(1);
+	scheduler.AddFrame(0, 2, 1, 1);
+	const int slow = scheduler.Assign(0);
+	const int fast = scheduler.Assign(1);
+	EXPECT_TRUE(scheduler.Complete(1, fast));
+
+	//The queue is empty, so the fast worker duplicates the slow tile
+	EXPECT_EQ(scheduler.Assign(1), slow);
+	EXPECT_TRUE(scheduler.Complete(1, slow));
+	EXPECT_TRUE(scheduler.IsFrameDone(0));
+
+	//The late result is ignored
+	EXPECT_FALSE(scheduler.Complete(0, slow));
+	EXPECT_EQ(scheduler.Assign(2), -1);
+}
+
+TEST(TileScheduler, RequeuesLostWorker) {
+	TileScheduler scheduler(4);
+	scheduler.AddFrame(0, 2, 1, 1);
+	scheduler.AddFrame(1, 1, 1, 1);
+	const int a = scheduler.Assign(0);
+	const int b = scheduler.Assign(0);
+	scheduler.RemoveWorker(0);
+	EXPECT_EQ(scheduler.NumQueued(), 3);
+	EXPECT_EQ(scheduler.Assign(1), a);
+	EXPECT_EQ(scheduler.Assign(1), b);
+}
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "UniformBlock.h"
+#include "UniformBlock.cpp"
+#include <sstream>
+
+static const UniformBlock::Layout test_layout[3] = {
+	{ "iMat", 16 },
+	{ "iPos", 3 },
+	{ "iScale", 1 },
+};
+
+TEST(UniformBlock, Changed) {
+	UniformBlock block(test_layout, 3);
+	EXPECT_TRUE(block.Changed().empty());
+	EXPECT_EQ(block.GetValues().size(), 20u);
+
+	block.Set(1, 1.0f, 2.0f, 3.0f);
+	const std::vector<int> changed = block.Changed();
+	ASSERT_EQ(changed.size(), 1u);
+	EXPECT_EQ(changed[0], 1);
+
+	block.Set(1, 0.0f, 0.0f, 0.0f);
+	EXPECT_TRUE(block.Changed().empty());
+}
+
+TEST(UniformBlock, SaveAndLoad) {
+	UniformBlock block(test_layout, 3);
+	float mat[16];
+	for (int i = 0; i < 16; ++i) {
+		mat[i] = float(i) * 0.1f;
+	}
+	block.Set(0, mat);
+	block.Set(1, -1.5f, 2.25f, 1e-6f);
+	block.Set(2, 1.3f);
+
+	std::stringstream ss;
+	block.Save(ss);
+	UniformBlock loaded(test_layout, 3);
+	EXPECT_TRUE(loaded.Load(ss));
+	EXPECT_EQ(loaded.GetValues(), block.GetValues());
+}
+
+TEST(UniformBlock, Find) {
+	UniformBlock block(test_layout, 3);
+	block.Set(1, 4.0f, 5.0f, 6.0f);
+	ASSERT_NE(block.Find("iPos"), nullptr);
+	EXPECT_EQ(block.Find("iPos")[2], 6.0f);
+	EXPECT_EQ(block.Find("iScale"), &block.GetValues()[19]);
+	EXPECT_EQ(block.Find("iMissing"), nullptr);
+}